@@ -32,18 +32,23 @@ int main(int argc, char **argv) {
     // Timing code. Timing doesn't include copying the input data to
     // the gpu or copying the output back.
 
+    BenchmarkConfig config;
+    config.min_samples = timing_iterations;
+
     // Manually-tuned version
-    double min_t_manual = benchmark(timing_iterations, 10, [&]() {
+    BenchmarkStatistics manual = benchmark_statistics([&]() {
         bilateral_grid(input, r_sigma, output);
-    });
-    printf("Manually-tuned time: %gms\n", min_t_manual * 1e3);
+    }, config);
+    report_benchmark("bilateral_grid/manual", manual);
+    printf("Manually-tuned time: %gms\n", manual.min * 1e3);
 
     #ifndef NO_AUTO_SCHEDULE
     // Auto-scheduled version
-    double min_t_auto = benchmark(timing_iterations, 10, [&]() {
+    BenchmarkStatistics automatic = benchmark_statistics([&]() {
         bilateral_grid_auto_schedule(input, r_sigma, output);
-    });
-    printf("Auto-scheduled time: %gms\n", min_t_auto * 1e3);
+    }, config);
+    report_benchmark("bilateral_grid/auto_schedule", automatic);
+    printf("Auto-scheduled time: %gms\n", automatic.min * 1e3);
     #endif
 
     convert_and_save_image(output, argv[2]);
@@ -63,22 +63,26 @@ int main(int argc, char **argv) {
     int blackLevel = 25;
     int whiteLevel = 1023;
 
-    double best;
+    BenchmarkConfig config;
+    config.min_samples = timing_iterations;
+    BenchmarkStatistics best;
 
-    best = benchmark(timing_iterations, 1, [&]() {
+    best = benchmark_statistics([&]() {
         camera_pipe(input, matrix_3200, matrix_7000,
                     color_temp, gamma, contrast, blackLevel, whiteLevel,
                     output);
-    });
-    fprintf(stderr, "Halide (manual):\t%gus\n", best * 1e6);
+    }, config);
+    report_benchmark("camera_pipe/manual", best);
+    fprintf(stderr, "Halide (manual):\t%gus\n", best.min * 1e6);
 
     #ifndef NO_AUTO_SCHEDULE
-    best = benchmark(timing_iterations, 1, [&]() {
+    best = benchmark_statistics([&]() {
         camera_pipe_auto_schedule(input, matrix_3200, matrix_7000,
             color_temp, gamma, contrast, blackLevel, whiteLevel,
             output);
-    });
-    fprintf(stderr, "Halide (auto):\t%gus\n", best * 1e6);
+    }, config);
+    report_benchmark("camera_pipe/auto_schedule", best);
+    fprintf(stderr, "Halide (auto):\t%gus\n", best.min * 1e6);
     #endif
 
     fprintf(stderr, "output: %s\n", argv[6]);
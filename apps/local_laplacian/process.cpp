@@ -32,18 +32,23 @@ int main(int argc, char **argv) {
 
     // Timing code
 
+    BenchmarkConfig config;
+    config.min_samples = timing;
+
     // Manually-tuned version
-    double best_manual = benchmark(timing, 1, [&]() {
+    BenchmarkStatistics manual = benchmark_statistics([&]() {
         local_laplacian(input, levels, alpha/(levels-1), beta, output);
-    });
-    printf("Manually-tuned time: %gms\n", best_manual * 1e3);
+    }, config);
+    report_benchmark("local_laplacian/manual", manual);
+    printf("Manually-tuned time: %gms\n", manual.min * 1e3);
 
     #ifndef NO_AUTO_SCHEDULE
     // Auto-scheduled version
-    double best_auto = benchmark(timing, 1, [&]() {
+    BenchmarkStatistics automatic = benchmark_statistics([&]() {
         local_laplacian_auto_schedule(input, levels, alpha/(levels-1), beta, output);
-    });
-    printf("Auto-scheduled time: %gms\n", best_auto * 1e3);
+    }, config);
+    report_benchmark("local_laplacian/auto_schedule", automatic);
+    printf("Auto-scheduled time: %gms\n", automatic.min * 1e3);
     #endif
 
     convert_and_save_image(output, argv[6]);
@@ -296,6 +296,7 @@ _output_extensions = {
     "o": ("o", False),
     "h": ("h", False),
     "cpp_stub": ("stub.h", False),
+    "instance": ("instance.h", False),
     "assembly": ("s.txt", True),
     "bitcode": ("bc", True),
     "stmt": ("stmt", True),
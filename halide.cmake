@@ -223,6 +223,8 @@ function(halide_library_from_generator BASENAME)
       list(APPEND OUTPUT_FILES "${GENFILES_DIR}/${BASENAME}.schedule")
     elseif ("${OUTPUT}" STREQUAL "html")
       list(APPEND OUTPUT_FILES "${GENFILES_DIR}/${BASENAME}.html")
+    elseif ("${OUTPUT}" STREQUAL "instance")
+      list(APPEND OUTPUT_FILES "${GENFILES_DIR}/${BASENAME}.instance.h")
     endif()
   endforeach()
 
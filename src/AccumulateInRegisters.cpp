@@ -0,0 +1,359 @@
+#include "AccumulateInRegisters.h"
+#include "Debug.h"
+#include "ExprUsesVar.h"
+#include "IREquality.h"
+#include "IRMutator.h"
+#include "IROperator.h"
+#include "Scope.h"
+#include "Simplify.h"
+#include "Util.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::map;
+using std::pair;
+using std::set;
+using std::string;
+using std::vector;
+
+namespace {
+
+// The most accumulators to hold in registers across a single loop. A
+// register-blocked matrix multiply needs around eight. Beyond this
+// many they would mostly be spilled anyway.
+const int max_accumulators = 32;
+
+// An element (or vector of elements) of a buffer that is loaded and
+// stored at the same loop-invariant index on every iteration.
+struct Accumulator {
+    Expr index;
+    Type type;
+    bool loaded, stored;
+    // The offset of the accumulator in its stack allocation.
+    int offset;
+};
+
+struct AccumulatedBuffer {
+    vector<Accumulator> accumulators;
+    Buffer<> image;
+    Parameter param;
+    string scratch;
+    int size;
+};
+
+class ContainsLoad : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *) override {
+        result = true;
+    }
+
+public:
+    bool result = false;
+};
+
+bool contains_load(const Expr &e) {
+    ContainsLoad c;
+    e.accept(&c);
+    return c.result;
+}
+
+// Find the buffers that the body of a loop only ever loads from and
+// stores to at loop-invariant indices. The body must be straight-line
+// code without side effects other than those stores, so that moving
+// the loads before the loop and the stores after it is safe.
+class FindAccumulators : public IRVisitor {
+    using IRVisitor::visit;
+
+    const string &loop_var;
+    // Variables defined inside the body, which may vary with the loop.
+    Scope<> varying;
+
+    void access(const string &name, Type t, const Expr &index, const Expr &predicate,
+                const Buffer<> &image, const Parameter &param, bool is_store) {
+        if (bad.count(name)) {
+            return;
+        }
+        // An index that depends on a load may change when the loop
+        // stores to the buffer it loads from.
+        if (!is_one(predicate) || expr_uses_var(index, loop_var) ||
+            expr_uses_vars(index, varying) || contains_load(index)) {
+            bad.insert(name);
+            return;
+        }
+        AccumulatedBuffer &b = buffers[name];
+        if (image.defined()) {
+            b.image = image;
+        }
+        if (param.defined()) {
+            b.param = param;
+        }
+        for (Accumulator &a : b.accumulators) {
+            if (equal(a.index, index)) {
+                if (a.type != t) {
+                    bad.insert(name);
+                }
+                a.loaded = a.loaded || !is_store;
+                a.stored = a.stored || is_store;
+                return;
+            }
+        }
+        if (!b.accumulators.empty() && b.accumulators[0].type.element_of() != t.element_of()) {
+            bad.insert(name);
+        }
+        b.accumulators.push_back({index, t, !is_store, is_store, 0});
+    }
+
+    void visit(const Let *op) override {
+        op->value.accept(this);
+        ScopedBinding<> bind(varying, op->name);
+        op->body.accept(this);
+    }
+
+    void visit(const LetStmt *op) override {
+        op->value.accept(this);
+        ScopedBinding<> bind(varying, op->name);
+        op->body.accept(this);
+    }
+
+    void visit(const Load *op) override {
+        IRVisitor::visit(op);
+        access(op->name, op->type, op->index, op->predicate, op->image, op->param, false);
+    }
+
+    void visit(const Store *op) override {
+        IRVisitor::visit(op);
+        access(op->name, op->value.type(), op->index, op->predicate, Buffer<>(), op->param, true);
+    }
+
+    void visit(const Variable *op) override {
+        // The buffer escapes, e.g. into a prefetch.
+        if (op->type.is_handle()) {
+            bad.insert(op->name);
+            if (ends_with(op->name, ".buffer")) {
+                bad.insert(op->name.substr(0, op->name.size() - 7));
+            }
+        }
+    }
+
+    void visit(const Call *op) override {
+        if (!op->is_pure() && !op->is_intrinsic(Call::prefetch)) {
+            straight_line = false;
+        }
+        IRVisitor::visit(op);
+    }
+
+    void visit(const For *) override {
+        straight_line = false;
+    }
+
+    void visit(const IfThenElse *) override {
+        straight_line = false;
+    }
+
+    void visit(const Allocate *) override {
+        straight_line = false;
+    }
+
+public:
+    FindAccumulators(const string &loop_var) : loop_var(loop_var) {}
+
+    bool straight_line = true;
+    map<string, AccumulatedBuffer> buffers;
+    set<string> bad;
+};
+
+// The index of the first lane of an accumulator, if it is a scalar or
+// a dense vector. Otherwise undefined.
+Expr dense_base(const Accumulator &a) {
+    if (!a.type.is_vector()) {
+        return a.index;
+    }
+    const Ramp *ramp = a.index.as<Ramp>();
+    if (ramp && is_one(ramp->stride)) {
+        return ramp->base;
+    }
+    return Expr();
+}
+
+// Accumulators are told apart by comparing their indices syntactically,
+// so the elements they cover must be proven not to overlap. The
+// enclosing lets may make the distance between them constant, e.g.
+// the strides of an allocation of constant size.
+bool provably_disjoint(const Accumulator &a, const Accumulator &b,
+                       const vector<pair<string, Expr>> &lets) {
+    Expr base_a = dense_base(a), base_b = dense_base(b);
+    if (!base_a.defined() || !base_b.defined()) {
+        return false;
+    }
+    Expr delta_expr = base_b - base_a;
+    for (auto it = lets.rbegin(); it != lets.rend(); ++it) {
+        if (expr_uses_var(delta_expr, it->first)) {
+            delta_expr = Let::make(it->first, it->second, delta_expr);
+        }
+    }
+    delta_expr = simplify(delta_expr);
+    while (const Let *let = delta_expr.as<Let>()) {
+        delta_expr = let->body;
+    }
+    const int64_t *delta = as_const_int(delta_expr);
+    return delta && (*delta >= a.type.lanes() || -*delta >= b.type.lanes());
+}
+
+Expr scratch_index(const Accumulator &a) {
+    if (a.type.is_vector()) {
+        return Ramp::make(a.offset, 1, a.type.lanes());
+    } else {
+        return a.offset;
+    }
+}
+
+// Redirect the loads and stores of the accumulators to their stack
+// allocations.
+class ReplaceAccumulators : public IRMutator2 {
+    using IRMutator2::visit;
+
+    const map<string, AccumulatedBuffer> &buffers;
+
+    const Accumulator &find(const AccumulatedBuffer &b, const Expr &index) {
+        for (const Accumulator &a : b.accumulators) {
+            if (equal(a.index, index)) {
+                return a;
+            }
+        }
+        internal_error << "Access to an accumulated buffer at an unknown index\n";
+        return b.accumulators[0];
+    }
+
+    Expr visit(const Load *op) override {
+        const auto &iter = buffers.find(op->name);
+        if (iter == buffers.end()) {
+            return IRMutator2::visit(op);
+        }
+        const Accumulator &a = find(iter->second, op->index);
+        return Load::make(op->type, iter->second.scratch, scratch_index(a),
+                          Buffer<>(), Parameter(), const_true(op->type.lanes()));
+    }
+
+    Stmt visit(const Store *op) override {
+        const auto &iter = buffers.find(op->name);
+        if (iter == buffers.end()) {
+            return IRMutator2::visit(op);
+        }
+        const Accumulator &a = find(iter->second, op->index);
+        return Store::make(iter->second.scratch, mutate(op->value), scratch_index(a),
+                           Parameter(), const_true(a.type.lanes()));
+    }
+
+public:
+    ReplaceAccumulators(const map<string, AccumulatedBuffer> &buffers) : buffers(buffers) {}
+};
+
+class AccumulateInRegisters : public IRMutator2 {
+    using IRMutator2::visit;
+
+    vector<pair<string, Expr>> lets;
+
+    Stmt visit(const LetStmt *op) override {
+        lets.push_back({op->name, op->value});
+        Stmt body = mutate(op->body);
+        lets.pop_back();
+        if (body.same_as(op->body)) {
+            return op;
+        }
+        return LetStmt::make(op->name, op->value, body);
+    }
+
+    Stmt visit(const For *op) override {
+        if (op->for_type == ForType::GPUBlock ||
+            op->for_type == ForType::GPUThread) {
+            // GPU kernels are compiled by a different code generator.
+            return op;
+        }
+
+        Stmt body = mutate(op->body);
+        Stmt stmt;
+        if (body.same_as(op->body)) {
+            stmt = op;
+        } else {
+            stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        }
+        if (op->for_type != ForType::Serial || is_one(op->extent)) {
+            return stmt;
+        }
+
+        FindAccumulators find(op->name);
+        body.accept(&find);
+        if (!find.straight_line) {
+            return stmt;
+        }
+
+        // Only accumulate into buffers that are both loaded from and
+        // stored to at each index, as in a reduction.
+        map<string, AccumulatedBuffer> buffers;
+        int count = 0;
+        for (auto &b : find.buffers) {
+            bool accumulated = !find.bad.count(b.first);
+            const vector<Accumulator> &accumulators = b.second.accumulators;
+            for (size_t i = 0; i < accumulators.size(); i++) {
+                accumulated = accumulated && accumulators[i].loaded && accumulators[i].stored;
+                for (size_t j = 0; j < i; j++) {
+                    accumulated = accumulated && provably_disjoint(accumulators[i], accumulators[j], lets);
+                }
+            }
+            if (!accumulated || count + (int)b.second.accumulators.size() > max_accumulators) {
+                continue;
+            }
+            count += b.second.accumulators.size();
+            AccumulatedBuffer &acc = buffers[b.first];
+            acc = b.second;
+            acc.scratch = unique_name(b.first + ".accumulator");
+            acc.size = 0;
+            for (Accumulator &a : acc.accumulators) {
+                a.offset = acc.size;
+                acc.size += a.type.lanes();
+            }
+        }
+        if (buffers.empty()) {
+            return stmt;
+        }
+
+        stmt = For::make(op->name, op->min, op->extent, op->for_type, op->device_api,
+                         ReplaceAccumulators(buffers).mutate(body));
+
+        vector<Stmt> loads, stores;
+        for (const auto &b : buffers) {
+            debug(3) << "Holding " << b.second.accumulators.size() << " accumulators of "
+                     << b.first << " in registers across the loop over " << op->name << "\n";
+            for (const Accumulator &a : b.second.accumulators) {
+                Expr value = Load::make(a.type, b.first, a.index, b.second.image, b.second.param,
+                                        const_true(a.type.lanes()));
+                loads.push_back(Store::make(b.second.scratch, value, scratch_index(a),
+                                            Parameter(), const_true(a.type.lanes())));
+                value = Load::make(a.type, b.second.scratch, scratch_index(a), Buffer<>(),
+                                   Parameter(), const_true(a.type.lanes()));
+                stores.push_back(Store::make(b.first, value, a.index, b.second.param,
+                                             const_true(a.type.lanes())));
+            }
+        }
+        stmt = Block::make(Block::make(loads), stmt);
+        stmt = Block::make(stmt, Block::make(stores));
+        for (const auto &b : buffers) {
+            stmt = Allocate::make(b.second.scratch, b.second.accumulators[0].type.element_of(),
+                                  {b.second.size}, const_true(), stmt);
+        }
+        // The accumulators may not be valid to load from if the loop
+        // doesn't run.
+        return IfThenElse::make(op->extent > 0, stmt);
+    }
+};
+
+}
+
+Stmt accumulate_in_registers(Stmt s) {
+    return AccumulateInRegisters().mutate(s);
+}
+
+}
+}
@@ -0,0 +1,38 @@
+#ifndef HALIDE_ACCUMULATE_IN_REGISTERS_H
+#define HALIDE_ACCUMULATE_IN_REGISTERS_H
+
+/** \file
+ * Defines a lowering pass that holds the accumulators of reductions
+ * in registers across the innermost loop over the reduction domain.
+ */
+
+#include "IR.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Find serial loops with straight-line bodies that accumulate into
+ * a fixed set of elements of some buffer, e.g. the loop over k in a
+ * register-blocked matrix multiply:
+ *
+ \code
+ for (k, 0, K) {
+   f[ramp(i, 1, 8)] = f[ramp(i, 1, 8)] + x8(a[k])*b[ramp(k*w, 1, 8)]
+   f[ramp(j, 1, 8)] = f[ramp(j, 1, 8)] + x8(a[k + w])*b[ramp(k*w, 1, 8)]
+ }
+ \endcode
+ *
+ * and rewrite them to load those elements into a small stack
+ * allocation before the loop, accumulate into it, and store it back
+ * to the buffer after the loop. LLVM promotes the stack allocation
+ * to registers, so the loop body no longer loads and stores the
+ * accumulators on every iteration. The elements must be at indices
+ * that are proven not to overlap, and the indices must not depend on
+ * loads. This is only done for targets with the
+ * accumulate_in_registers feature. */
+Stmt accumulate_in_registers(Stmt s);
+
+}
+}
+
+#endif
@@ -95,10 +95,12 @@ Stmt add_image_checks(Stmt s,
                       const Target &t,
                       const vector<string> &order,
                       const map<string, Function> &env,
-                      const FuncValueBounds &fb) {
+                      const FuncValueBounds &fb,
+                      bool skip_argument_checks) {
 
-    bool no_asserts = t.has_feature(Target::NoAsserts);
-    bool no_bounds_query = t.has_feature(Target::NoBoundsQuery);
+    bool no_alignment_asserts = t.has_feature(Target::NoAsserts);
+    bool no_asserts = no_alignment_asserts || skip_argument_checks;
+    bool no_bounds_query = t.has_feature(Target::NoBoundsQuery) || skip_argument_checks;
 
     // First hunt for all the referenced buffers
     FindBuffers finder;
@@ -563,6 +565,8 @@ Stmt add_image_checks(Stmt s,
         for (size_t i = asserts_host_non_null.size(); i > 0; i--) {
             s = Block::make(asserts_host_non_null[i-1], s);
         }
+    }
+    if (!no_alignment_asserts) {
         for (size_t i = asserts_host_alignment.size(); i > 0; i--) {
             s = Block::make(asserts_host_alignment[i-1], s);
         }
@@ -21,13 +21,19 @@ namespace Internal {
 /** Insert checks to make sure a statement doesn't read out of bounds
  * on inputs or outputs, and that the inputs and outputs conform to
  * the format required (e.g. stride.0 must be 1).
+ *
+ * If skip_argument_checks is true, the buffers are trusted: there are
+ * no bounds queries, and the only checks are those of the host
+ * alignment, which the generated code relies on. The symbols for the
+ * regions of the buffers that are required are still defined.
  */
 Stmt add_image_checks(Stmt s,
                       const std::vector<Function> &outputs,
                       const Target &t,
                       const std::vector<std::string> &order,
                       const std::map<std::string, Function> &env,
-                      const FuncValueBounds &fb);
+                      const FuncValueBounds &fb,
+                      bool skip_argument_checks = false);
 
 
 }
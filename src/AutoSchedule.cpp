@@ -3,6 +3,7 @@
 
 #include "AutoSchedule.h"
 #include "AutoScheduleUtils.h"
+#include "Associativity.h"
 #include "ExprUsesVar.h"
 #include "FindCalls.h"
 #include "Func.h"
@@ -13,6 +14,7 @@
 #include "RegionCosts.h"
 #include "Scope.h"
 #include "Simplify.h"
+#include "ThreadPool.h"
 #include "Util.h"
 
 namespace Halide {
@@ -28,6 +30,75 @@ using std::make_pair;
 
 namespace {
 
+// Return the number of threads to use when evaluating independent grouping
+// choices. This can be set with HL_AUTO_SCHEDULE_THREADS, and defaults to the
+// number of cores. When debugging, use a single thread so that the debug
+// output isn't interleaved.
+size_t auto_schedule_threads() {
+    if (debug::debug_level() > 0) {
+        return 1;
+    }
+    string threads = get_env_variable("HL_AUTO_SCHEDULE_THREADS");
+    if (!threads.empty()) {
+        return std::max(atoi(threads.c_str()), 1);
+    }
+    return ThreadPool<void>::num_processors_online();
+}
+
+// Return true if the auto-scheduler should insert software prefetches for
+// streaming input loads. This is off by default, and can be turned on by
+// setting HL_AUTO_SCHEDULE_PREFETCH=1.
+bool auto_schedule_prefetch() {
+    string prefetch = get_env_variable("HL_AUTO_SCHEDULE_PREFETCH");
+    return !prefetch.empty() && prefetch != "0";
+}
+
+// Apply 'f' to each element of 'in' using up to 'num_threads' threads. The
+// results are returned in the order of 'in', so the caller sees the same
+// thing regardless of the order in which the threads finish.
+template<typename R, typename T, typename F>
+vector<R> parallel_map(const vector<T> &in, F f, size_t num_threads) {
+    vector<R> out(in.size());
+    if (num_threads <= 1 || in.size() <= 1) {
+        for (size_t i = 0; i < in.size(); i++) {
+            out[i] = f(in[i]);
+        }
+        return out;
+    }
+    ThreadPool<void> pool(std::min(num_threads, in.size()));
+    vector<std::future<void>> futures;
+#ifdef WITH_EXCEPTIONS
+    // Errors are thrown as exceptions, which must be rethrown on the
+    // calling thread.
+    vector<std::exception_ptr> errors(in.size());
+    for (size_t i = 0; i < in.size(); i++) {
+        futures.push_back(pool.async([&in, &out, &f, &errors, i]() {
+            try {
+                out[i] = f(in[i]);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }));
+    }
+    for (auto &fut : futures) {
+        fut.wait();
+    }
+    for (const auto &e : errors) {
+        if (e) {
+            std::rethrow_exception(e);
+        }
+    }
+#else
+    for (size_t i = 0; i < in.size(); i++) {
+        futures.push_back(pool.async([&in, &out, &f, i]() { out[i] = f(in[i]); }));
+    }
+    for (auto &fut : futures) {
+        fut.wait();
+    }
+#endif
+    return out;
+}
+
 int string_to_int(const std::string &s) {
     std::istringstream iss(s);
     int i;
@@ -184,8 +255,10 @@ struct DependenceAnalysis {
             : bounds(b), regions(r) {}
     };
     // Cache for bounds queries (bound queries with the same parameters are
-    // common during the grouping process).
+    // common during the grouping process). Grouping choices are evaluated
+    // in parallel, so accesses to the cache are guarded by a mutex.
     map<RegionsRequiredQuery, vector<RegionsRequired>> regions_required_cache;
+    std::mutex regions_required_cache_mutex;
 
     DependenceAnalysis(const map<string, Function> &env, const vector<string> &order,
                        const FuncValueBounds &func_val_bounds)
@@ -387,13 +460,16 @@ DependenceAnalysis::regions_required(Function f, int stage_num,
 
     // Check the cache if we've already computed this previously.
     RegionsRequiredQuery query(f.name(), stage_num, prods, only_regions_computed);
-    const auto &iter = regions_required_cache.find(query);
-    if (iter != regions_required_cache.end()) {
-        const auto &it = std::find_if(iter->second.begin(), iter->second.end(),
-            [&bounds](const RegionsRequired &r) { return (r.bounds == bounds); });
-        if (it != iter->second.end()) {
-            internal_assert((iter->first == query) && (it->bounds == bounds));
-            return it->regions;
+    {
+        std::lock_guard<std::mutex> lock(regions_required_cache_mutex);
+        const auto &iter = regions_required_cache.find(query);
+        if (iter != regions_required_cache.end()) {
+            const auto &it = std::find_if(iter->second.begin(), iter->second.end(),
+                [&bounds](const RegionsRequired &r) { return (r.bounds == bounds); });
+            if (it != iter->second.end()) {
+                internal_assert((iter->first == query) && (it->bounds == bounds));
+                return it->regions;
+            }
         }
     }
 
@@ -574,6 +650,9 @@ DependenceAnalysis::regions_required(Function f, int stage_num,
         concrete_regions[f_reg.first] = concrete_box;
     }
 
+    // Another thread may have computed the same query in the meantime; the
+    // results are identical, so it doesn't matter which one ends up cached.
+    std::lock_guard<std::mutex> lock(regions_required_cache_mutex);
     regions_required_cache[query].push_back(RegionsRequired(bounds, concrete_regions));
     return concrete_regions;
 }
@@ -1171,6 +1250,46 @@ struct Partitioner {
                                      const set<string> &inlines,
                                      AutoSchedule &sched);
 
+    // If the update stage 'f_handle' (the output of group 'g') is a large
+    // associative reduction whose pure dimensions do not expose enough
+    // parallelism, split its outermost RVar and rfactor() the outer part into
+    // an intermediate function, which is computed at root and parallelized
+    // over the rfactored dimension. Return true if the stage was rfactored,
+    // in which case no further schedule should be applied to the stage.
+    bool rfactor_stage(const Group &g, Stage f_handle, Definition def,
+                       map<string, Expr> estimates, AutoSchedule &sched);
+
+    // If the update stage 'f_handle' (the output of group 'g') is a matrix
+    // multiply, i.e. f(x, y) += a(k, y) * b(x, k) over a single RVar 'k', block
+    // it into a micro-kernel that accumulates a tile of two vectors along 'x'
+    // by four rows along 'y' in registers, with the panel of 'b' the tile
+    // walks along 'k' packed
+    // into a contiguous buffer. Only used for targets with the
+    // accumulate_in_registers feature. Return true if the stage was
+    // scheduled this way, in which case no further schedule should be applied
+    // to the stage.
+    bool register_tile_stage(const Group &g, Stage f_handle, Definition def,
+                             map<string, Expr> estimates, const Target &t,
+                             AutoSchedule &sched);
+
+    // Insert prefetches of the data from outside of group 'g' that is
+    // streamed through by the stage 'stg' of the group. Each prefetch is
+    // placed at the innermost serial loop of the stage whose iterations step
+    // by at least a cache line through the data. The prefetch distance is
+    // chosen so that roughly 'balance' cache lines are in flight, without the
+    // prefetched data exceeding each core's share of the last level cache.
+    void prefetch_stage(const Group &g, const FStage &stg, Stage f_handle,
+                        const map<string, Box> &group_storage_bounds,
+                        const set<string> &inlines,
+                        const map<string, Expr> &estimates, AutoSchedule &sched);
+
+    // Pad the innermost storage dimension of the intermediate function 'f' if,
+    // given the estimated bounds 'storage' of its realizations, the stride of
+    // the next dimension out is a multiple of 1024 bytes. Such critical strides
+    // are common with power-of-two extents, and cause cache set conflicts when
+    // 'f' is accessed along columns.
+    void pad_storage(Function f, const Box &storage, AutoSchedule &sched);
+
     // Split the dimension of stage 'f_handle' along 'v' into inner and outer
     // dimensions. Modify 'estimates' according to the split and append the split
     // schedule to 'sched'.
@@ -1189,8 +1308,9 @@ struct Partitioner {
     // Reorder the dimensions to preserve spatial locality. This function
     // checks the stride of each access. The dimensions of the loop are reordered
     // such that the dimension with the smallest access stride is innermost.
-    // This takes the strides along each dimension as input.
-    void reorder_dims(Stage f_handle, int stage_num, Definition def,
+    // This takes the strides along each dimension as input. RVars are only
+    // reordered relative to each other if 'func' can be proven to allow it.
+    void reorder_dims(Stage f_handle, int stage_num, Definition def, Function func,
                       map<string, Expr> strides, AutoSchedule &sched);
 
     // Helper functions to display partition information of the pipeline.
@@ -1376,10 +1496,23 @@ Partitioner::Partitioner(const map<string, Box> &_pipeline_bounds,
 }
 
 void Partitioner::initialize_groups() {
+    vector<Group> initial;
+    for (const pair<const FStage, Group> &g : groups) {
+        initial.push_back(g.second);
+    }
+
+    // The groups are independent of each other, so find their best tile
+    // configurations in parallel.
+    vector<pair<map<string, Expr>, GroupAnalysis>> best =
+        parallel_map<pair<map<string, Expr>, GroupAnalysis>>(
+            initial, [this](const Group &g) { return find_best_tile_config(g); },
+            auto_schedule_threads());
+
+    size_t i = 0;
     for (pair<const FStage, Group> &g : groups) {
-        pair<map<string, Expr>, GroupAnalysis> best = find_best_tile_config(g.second);
-        g.second.tile_sizes = best.first;
-        group_costs.emplace(g.second.output, best.second);
+        g.second.tile_sizes = best[i].first;
+        group_costs.emplace(g.second.output, best[i].second);
+        i++;
     }
     grouping_cache.clear();
 }
@@ -1433,6 +1566,29 @@ map<string, Expr> Partitioner::evaluate_reuse(const FStage &stg,
 vector<pair<Partitioner::GroupingChoice, Partitioner::GroupConfig>>
 Partitioner::choose_candidate_grouping(const vector<pair<string, string>> &cands,
                                        Partitioner::Level level) {
+    // Evaluate all the grouping choices that aren't already in the cache up
+    // front. The evaluations are independent of each other, so do them in
+    // parallel; the choice of the best grouping below is still made serially
+    // in candidate order.
+    vector<GroupingChoice> uncached;
+    for (const auto &p : cands) {
+        const Function &prod_f = get_element(dep_analysis.env, p.first);
+        FStage prod(prod_f, prod_f.updates().size());
+        for (const FStage &c : get_element(children, prod)) {
+            GroupingChoice cand_choice(prod_f.name(), c);
+            if (grouping_cache.find(cand_choice) == grouping_cache.end() &&
+                std::find(uncached.begin(), uncached.end(), cand_choice) == uncached.end()) {
+                uncached.push_back(cand_choice);
+            }
+        }
+    }
+    vector<GroupConfig> configs = parallel_map<GroupConfig>(
+        uncached, [this, level](const GroupingChoice &c) { return evaluate_choice(c, level); },
+        auto_schedule_threads());
+    for (size_t i = 0; i < uncached.size(); i++) {
+        grouping_cache.emplace(uncached[i], configs[i]);
+    }
+
     vector<pair<GroupingChoice, GroupConfig>> best_grouping;
     Expr best_benefit = make_zero(Int(64));
     for (const auto &p : cands) {
@@ -1514,11 +1670,12 @@ vector<map<string, Expr>> Partitioner::generate_tile_configs(const FStage &stg)
     Definition def = get_stage_definition(stg.func, stg.stage_num);
     const vector<Dim> &dims = def.schedule().dims();
 
-    // Get the dimensions that are going to be tiled in this stage.
-    // Skipping rvars for now.
+    // Get the dimensions that are going to be tiled in this stage. RVars
+    // are only tiled if their loops can be interchanged.
+    bool tile_rvars = (stg.stage_num > 0) && can_permute_rvars(stg.func.name(), def);
     vector<string> tile_vars;
     for (int d = 0; d < (int)dims.size() - 1; d++) {
-        if (!dims[d].is_rvar()) {
+        if (!dims[d].is_rvar() || tile_rvars) {
             tile_vars.push_back(dims[d].var);
         }
     }
@@ -2363,6 +2520,261 @@ bool access_inputs_or_outputs(Definition def, VarOrRVar var,
     return false;
 }
 
+bool Partitioner::rfactor_stage(const Group &g, Stage f_handle, Definition def,
+                                map<string, Expr> estimates, AutoSchedule &sched) {
+    const Function &g_out = g.output.func;
+    int stage_num = g.output.stage_num;
+    internal_assert(stage_num > 0);
+
+    // Other members of the group would have to be computed within the loop
+    // nest of the stage, which rfactor() moves into the intermediate function.
+    for (const FStage &mem : g.members) {
+        if ((g.inlined.find(mem.func.name()) == g.inlined.end()) &&
+            (mem.func.name() != g_out.name())) {
+            return false;
+        }
+    }
+
+    const vector<Dim> &dims = def.schedule().dims();
+    Expr pure_size = make_one(Int(64));
+    Expr reduction_size = make_one(Int(64));
+    int outer_rvar = -1;
+    for (int d = 0; d < (int)dims.size() - 1; d++) {
+        string var = get_base_name(dims[d].var);
+        const auto &iter = estimates.find(var);
+        if ((iter == estimates.end()) || !iter->second.defined()) {
+            return false;
+        }
+        if (dims[d].is_rvar()) {
+            if (can_parallelize_rvar(var, g_out.name(), def)) {
+                // Can already be parallelized directly.
+                return false;
+            }
+            reduction_size = simplify(reduction_size * cast<int64_t>(iter->second));
+            outer_rvar = d;
+        } else {
+            pure_size = simplify(pure_size * cast<int64_t>(iter->second));
+        }
+    }
+
+    if ((outer_rvar < 0) ||
+        !can_prove(pure_size < arch_params.parallelism) ||
+        !can_prove(reduction_size > pure_size)) {
+        return false;
+    }
+
+    if (!prove_associativity(g_out.name(), def.args(), def.values()).associative()) {
+        return false;
+    }
+
+    string rvar_name = get_base_name(dims[outer_rvar].var);
+    Expr factor = simplify(max(get_element(estimates, rvar_name) / arch_params.parallelism, 1));
+    if (!as_const_int(factor)) {
+        return false;
+    }
+
+    debug(3) << "Rfactoring " << f_handle.name() << " along " << rvar_name << '\n';
+
+    // The stage's RVars are replaced by rfactor(), so the split RVar has to
+    // be declared explicitly in the printed schedule.
+    VarOrRVar rv(rvar_name, true);
+    sched.internal_vars.emplace(rvar_name, rv);
+    pair<VarOrRVar, VarOrRVar> split_vars =
+        split_dim(g, f_handle, stage_num, def, true, rv, factor, "_i", "_o",
+                  estimates, sched);
+    const VarOrRVar &outer = split_vars.second;
+
+    Var u(outer.name() + "_par");
+    sched.internal_vars.emplace(u.name(), VarOrRVar(u));
+
+    Func intm = f_handle.rfactor(outer.rvar, u);
+    intm.compute_root();
+    intm.update(0).parallel(u);
+    sched.push_schedule(f_handle.name(), stage_num,
+                        "rfactor(" + outer.name() + ", " + u.name() + ")"
+                        ".compute_root().update(0).parallel(" + u.name() + ")",
+                        {outer.name(), u.name()});
+    return true;
+}
+
+// If 'def' is the update f(x, y) = f(x, y) + a*b of a matrix multiply named
+// 'func', where 'a' depends on the single RVar and 'y' but not 'x', and 'b'
+// depends on the RVar and 'x' but not 'y', return 'b'. Otherwise return an
+// undefined Expr.
+Expr find_matrix_multiply_operand(const string &func, Definition def) {
+    const vector<Expr> &args = def.args();
+    const vector<ReductionVariable> &rvars = def.schedule().rvars();
+    if ((def.values().size() != 1) || (args.size() != 2) ||
+        (rvars.size() != 1) || !is_one(def.predicate())) {
+        return Expr();
+    }
+    const Variable *x = args[0].as<Variable>();
+    const Variable *y = args[1].as<Variable>();
+    const Add *add = def.values()[0].as<Add>();
+    if (!x || !y || !add) {
+        return Expr();
+    }
+
+    Expr terms[] = {add->a, add->b};
+    for (int i = 0; i < 2; i++) {
+        const Call *self = terms[i].as<Call>();
+        const Mul *mul = terms[1 - i].as<Mul>();
+        if (!self || (self->call_type != Call::Halide) || (self->name != func) ||
+            !equal(self->args[0], args[0]) || !equal(self->args[1], args[1]) || !mul) {
+            continue;
+        }
+
+        FindAllCalls find;
+        mul->accept(&find);
+        if (find.funcs_called.count(func)) {
+            return Expr();
+        }
+
+        const string &k = rvars[0].var;
+        Expr operands[] = {mul->a, mul->b};
+        for (int j = 0; j < 2; j++) {
+            const Expr &a = operands[j], &b = operands[1 - j];
+            if (expr_uses_var(a, k) && expr_uses_var(a, y->name) && !expr_uses_var(a, x->name) &&
+                expr_uses_var(b, k) && expr_uses_var(b, x->name) && !expr_uses_var(b, y->name)) {
+                return b;
+            }
+        }
+    }
+    return Expr();
+}
+
+bool Partitioner::register_tile_stage(const Group &g, Stage f_handle, Definition def,
+                                      map<string, Expr> estimates, const Target &t,
+                                      AutoSchedule &sched) {
+    const Function &g_out = g.output.func;
+    int stage_num = g.output.stage_num;
+    internal_assert(stage_num > 0);
+
+    // As with rfactor_stage, other members of the group would need a compute
+    // level within the tiles.
+    for (const FStage &mem : g.members) {
+        if ((g.inlined.find(mem.func.name()) == g.inlined.end()) &&
+            (mem.func.name() != g_out.name())) {
+            return false;
+        }
+    }
+
+    Expr b = find_matrix_multiply_operand(g_out.name(), def);
+    if (!b.defined() || def.schedule().dims().size() != 4) {
+        return false;
+    }
+
+    const string x = def.args()[0].as<Variable>()->name;
+    const string y = def.args()[1].as<Variable>()->name;
+    const string k = def.schedule().rvars()[0].var;
+    const Expr &x_est = get_element(estimates, x);
+    const Expr &y_est = get_element(estimates, y);
+    const Expr &k_est = get_element(estimates, k);
+    if (!x_est.defined() || !y_est.defined() || !k_est.defined()) {
+        return false;
+    }
+
+    // The micro-kernel accumulates a tile of two vectors by four rows of the
+    // output in registers, so per iteration of 'k' it does eight vector
+    // multiply-adds with two vector loads of 'b' and four broadcast loads of
+    // 'a'. This fits in the sixteen vector registers of SSE, AVX and NEON.
+    const int vec = t.natural_vector_size(def.values()[0].type());
+    const int tile_x = 2 * vec, tile_y = 4;
+    // Each task computes 'block_y' rows of the output, a panel of 'block_k'
+    // columns of 'a' at a time, so that the panel of 'a' stays in the L2
+    // cache while the panel of 'b' the micro-kernel walks along 'k' stays in
+    // the L1 cache.
+    const int block_y = 16 * tile_y, block_k = 256;
+    if (vec < 2 || !can_prove(x_est >= tile_x) || !can_prove(y_est >= tile_y) ||
+        !can_prove(k_est >= 16)) {
+        return false;
+    }
+
+    debug(3) << "Register tiling matrix multiply " << f_handle.name() << '\n';
+
+    pair<VarOrRVar, VarOrRVar> x_vars =
+        split_dim(g, f_handle, stage_num, def, true, VarOrRVar(x, false), tile_x,
+                  "_i", "_o", estimates, sched);
+    pair<VarOrRVar, VarOrRVar> y_vars =
+        split_dim(g, f_handle, stage_num, def, true, VarOrRVar(y, false), tile_y,
+                  "_i", "_o", estimates, sched);
+    VarOrRVar x_i = x_vars.first, x_o = x_vars.second;
+    VarOrRVar y_i = y_vars.first, y_o = y_vars.second;
+
+    // Split off the loops over the blocks of rows and columns of 'a'.
+    vector<VarOrRVar> ordering = {x_i, y_i};
+    vector<VarOrRVar> outer;
+    if (can_prove(get_element(estimates, y_o.name()) > block_y / tile_y)) {
+        pair<VarOrRVar, VarOrRVar> vars =
+            split_dim(g, f_handle, stage_num, def, true, y_o, block_y / tile_y,
+                      "_i", "_o", estimates, sched);
+        y_o = vars.second;
+        outer.push_back(vars.first);
+    }
+    if (can_prove(k_est > block_k)) {
+        pair<VarOrRVar, VarOrRVar> vars =
+            split_dim(g, f_handle, stage_num, def, true, VarOrRVar(k, true), block_k,
+                      "_i", "_o", estimates, sched);
+        ordering.push_back(vars.first);
+        outer.push_back(x_o);
+        outer.push_back(vars.second);
+    } else {
+        ordering.push_back(VarOrRVar(k, true));
+        outer.push_back(x_o);
+    }
+    bool reuses_b = outer.size() > 1 && outer[0].name() != x_o.name();
+    ordering.insert(ordering.end(), outer.begin(), outer.end());
+    ordering.push_back(y_o);
+
+    set<string> var_list;
+    string var_order = ordering[0].name();
+    for (size_t o = 1; o < ordering.size(); o++) {
+        var_order += ", " + ordering[o].name();
+        var_list.insert(ordering[o].name());
+    }
+    f_handle.reorder(ordering);
+    sched.push_schedule(f_handle.name(), stage_num, "reorder(" + var_order + ")", var_list);
+
+    f_handle.vectorize(x_i, vec).unroll(x_i).unroll(y_i).parallel(y_o);
+    sched.push_schedule(f_handle.name(), stage_num,
+                        "vectorize(" + x_i.name() + ", " + std::to_string(vec) + ")"
+                        ".unroll(" + x_i.name() + ").unroll(" + y_i.name() + ")"
+                        ".parallel(" + y_o.name() + ")",
+                        {x_i.name(), y_i.name(), y_o.name()});
+
+    // Pack the panel of 'b' read by the micro-kernel into a dense buffer, so
+    // that its rows don't conflict in the cache when the stride of 'b' is a
+    // power of two. The packed panel is reused by every tile in the block of
+    // rows. ImageParams are called through a wrapper Func, so this applies to
+    // them too, but not to calls to a Buffer, which have no Func to wrap.
+    const Call *call = b.as<Call>();
+    if (reuses_b && call && (call->call_type == Call::Halide) && (call->args.size() == 2) &&
+        dep_analysis.env.count(call->name)) {
+        int inner = expr_uses_var(call->args[0], x) ? 0 : 1;
+        const Function &b_func = get_element(dep_analysis.env, call->name);
+        if (expr_uses_var(call->args[inner], x) && !expr_uses_var(call->args[inner], k) &&
+            expr_uses_var(call->args[1 - inner], k) && !b_func.has_extern_definition()) {
+            Var b_x(b_func.args()[inner]), b_k(b_func.args()[1 - inner]);
+            string sanitized_g_out = get_sanitized_name(g_out.name());
+            std::ostringstream oss;
+            oss << "in(" << sanitized_g_out << ").compute_at(" << sanitized_g_out
+                << ", " << x_o.name() << ")";
+            Func packed = Func(b_func).in(Func(g_out)).compute_at(Func(g_out), x_o.var);
+            if (inner != 0) {
+                packed.reorder_storage(b_x, b_k).reorder(b_x, b_k);
+                oss << ".reorder_storage(" << b_x.name() << ", " << b_k.name() << ")"
+                    << ".reorder(" << b_x.name() << ", " << b_k.name() << ")";
+            }
+            packed.vectorize(b_x, vec);
+            oss << ".vectorize(" << b_x.name() << ", " << vec << ")";
+            sched.push_schedule(b_func.name(), 0, oss.str(),
+                                {sanitized_g_out, x_o.name(), b_x.name(), b_k.name()});
+        }
+    }
+
+    return true;
+}
+
 pair<VarOrRVar, VarOrRVar> Partitioner::split_dim(
         const Group &g, Stage f_handle, int stage_num, Definition def,
         bool is_group_output, VarOrRVar v, const Expr &factor, string in_suffix,
@@ -2544,12 +2956,16 @@ inline bool operator!=(const vector<Dim> &dims, const vector<VarOrRVar> &orderin
     return !(dims == ordering);
 }
 
-void Partitioner::reorder_dims(Stage f_handle, int stage_num, Definition def,
+void Partitioner::reorder_dims(Stage f_handle, int stage_num, Definition def, Function func,
                                map<string, Expr> strides, AutoSchedule &sched) {
     vector<Dim> &dims = def.schedule().dims();
     internal_assert(dims.size() > 1);
     vector<pair<string, bool>> order;
 
+    // None of the RVars have been split yet, so they can be put in any
+    // order if their loops can be interchanged at all.
+    bool permutable_rvars = (stage_num > 0) && can_permute_rvars(func.name(), def);
+
     for (int d = 0; d < (int)dims.size() - 1; d++) {
         internal_assert(strides.find(dims[d].var) != strides.end());
     }
@@ -2598,9 +3014,11 @@ void Partitioner::reorder_dims(Stage f_handle, int stage_num, Definition def,
                     min_impure_var = var_name;
                     min_impure_index = d;
                     // Impure dimensions cannot be reordered relative to
-                    // each other. Stop after encountering the first impure
-                    // dimension.
-                    break;
+                    // each other, unless the update definition allows it.
+                    // Stop after encountering the first impure dimension.
+                    if (!permutable_rvars) {
+                        break;
+                    }
                 }
             }
         }
@@ -2664,6 +3082,190 @@ public :
     }
 };
 
+void Partitioner::prefetch_stage(const Group &g, const FStage &stg, Stage f_handle,
+                                 const map<string, Box> &group_storage_bounds,
+                                 const set<string> &inlines,
+                                 const map<string, Expr> &estimates,
+                                 AutoSchedule &sched) {
+    Definition def = get_stage_definition(stg.func, stg.stage_num);
+
+    const int64_t *llc_size = as_const_int(arch_params.last_level_cache_size);
+    const int64_t *parallelism = as_const_int(arch_params.parallelism);
+    const int64_t *balance = as_const_int(arch_params.balance);
+    if (!llc_size || !parallelism || !balance) {
+        return;
+    }
+
+    // Loops that step by less than a cache line through an input are left
+    // to the hardware prefetcher.
+    const int64_t cache_line = 64;
+
+    // Attribute the loads of the inlined functions to the stage.
+    vector<Expr> exprs;
+    for (const Expr &val : def.values()) {
+        exprs.push_back(perform_inline(val, dep_analysis.env, inlines));
+    }
+    for (const Expr &arg : def.args()) {
+        exprs.push_back(perform_inline(arg, dep_analysis.env, inlines));
+    }
+    FindAllCalls find;
+    for (const Expr &e : exprs) {
+        e.accept(&find);
+    }
+
+    // Only the pipeline inputs and the functions computed outside of the
+    // group are streamed through by the stage. Inputs bound to a concrete
+    // Buffer cannot be prefetched, since they have no Parameter.
+    map<string, vector<vector<Expr>>> accesses;
+    for (const auto &call : find.call_args) {
+        const string &name = call.first;
+        if (dep_analysis.env.find(name) != dep_analysis.env.end()) {
+            bool is_member = false;
+            for (const FStage &mem : g.members) {
+                is_member = is_member || (mem.func.name() == name);
+            }
+            if (is_member) {
+                continue;
+            }
+        } else if (find.image_params.find(name) == find.image_params.end()) {
+            continue;
+        }
+        accesses[name].push_back(call.second);
+    }
+    if (accesses.empty()) {
+        return;
+    }
+
+    // Each prefetched input gets an equal share of a core's slice of the
+    // last level cache for the data fetched ahead of use.
+    int64_t budget = *llc_size / (std::max(*parallelism, (int64_t)1) * accesses.size());
+
+    const vector<Dim> &dims = def.schedule().dims();
+    for (const auto &acc : accesses) {
+        const string &name = acc.first;
+
+        Box bounds;
+        int64_t bytes_per_ele = 0;
+        const auto &f_iter = dep_analysis.env.find(name);
+        if (f_iter != dep_analysis.env.end()) {
+            for (const Type &t : f_iter->second.output_types()) {
+                bytes_per_ele += t.bytes();
+            }
+        } else {
+            bytes_per_ele = get_element(find.image_params, name).type().bytes();
+        }
+        const auto &b_iter = group_storage_bounds.find(name);
+        if (b_iter != group_storage_bounds.end()) {
+            bounds = b_iter->second;
+        } else {
+            bounds = get_element(pipeline_bounds, name);
+        }
+
+        // Walk the loops from innermost to outermost, keeping track of the
+        // number of elements of the input touched by the loops inside.
+        int64_t inner_elems = 1;
+        for (int d = 0; d < (int)dims.size() - 1; d++) {
+            if (dims[d].for_type == ForType::Parallel) {
+                break;
+            }
+
+            string var = get_base_name(dims[d].var);
+            const auto &e_iter = estimates.find(var);
+            if ((e_iter == estimates.end()) || !e_iter->second.defined()) {
+                break;
+            }
+            Expr extent_expr = simplify(cast<int64_t>(e_iter->second));
+            const int64_t *extent = as_const_int(extent_expr);
+            if (!extent) {
+                break;
+            }
+
+            // The accesses are expressed in terms of the original dimension
+            // of the stage that this loop was split from.
+            string root_var = dims[d].var.substr(0, dims[d].var.find('.'));
+            FindVarsUsingVar dep_vars(root_var);
+            for (const Expr &e : exprs) {
+                e.accept(&dep_vars);
+            }
+            Expr stride = make_zero(Int(64));
+            for (const vector<Expr> &args : acc.second) {
+                Expr s = find_max_access_stride(dep_vars.vars, name, args, bounds);
+                if (!s.defined()) {
+                    stride = Expr();
+                    break;
+                }
+                stride = max(stride, s);
+            }
+            if (stride.defined()) {
+                stride = simplify(stride);
+            }
+            const int64_t *stride_bytes = stride.defined() ? as_const_int(stride) : nullptr;
+            if (!stride_bytes) {
+                break;
+            }
+            if (*stride_bytes == 0) {
+                continue;
+            }
+
+            if ((dims[d].for_type != ForType::Vectorized) &&
+                (*stride_bytes >= cache_line) && (*extent > 1)) {
+                int64_t footprint = std::max(inner_elems * bytes_per_ele, cache_line);
+                if (footprint > budget) {
+                    break;
+                }
+                int64_t distance = (*balance * cache_line + footprint - 1) / footprint;
+                distance = std::min(distance, budget / footprint);
+                distance = std::max(std::min(distance, *extent - 1), (int64_t)1);
+
+                debug(3) << "Prefetching " << name << " in " << f_handle.name()
+                         << " at " << var << " with distance " << distance << '\n';
+
+                VarOrRVar v(var, dims[d].is_rvar());
+                if (f_iter != dep_analysis.env.end()) {
+                    f_handle.prefetch(Func(f_iter->second), v, (int)distance);
+                } else {
+                    f_handle.prefetch(get_element(find.image_params, name), v, (int)distance);
+                }
+                sched.push_schedule(f_handle.name(), stg.stage_num,
+                                    "prefetch(" + get_sanitized_name(name) + ", " + var +
+                                    ", " + std::to_string(distance) + ")",
+                                    {var});
+                break;
+            }
+            inner_elems *= *extent;
+        }
+    }
+}
+
+void Partitioner::pad_storage(Function f, const Box &storage, AutoSchedule &sched) {
+    const vector<StorageDim> &storage_dims = f.schedule().storage_dims();
+    const vector<string> &args = f.args();
+    if ((storage_dims.size() < 2) || (storage.size() != args.size())) {
+        return;
+    }
+
+    const string &var = storage_dims[0].var;
+    for (size_t i = 0; i < args.size(); i++) {
+        if (args[i] != var) {
+            continue;
+        }
+        Expr extent = simplify(get_extent(storage[i]));
+        const int64_t *e = as_const_int(extent);
+        if (!e) {
+            return;
+        }
+        for (const Type &t : f.output_types()) {
+            if ((*e * t.bytes()) % 1024 == 0) {
+                debug(3) << "Padding the storage of " << f.name() << " along " << var << '\n';
+                Func(f).pad_storage(Var(var));
+                sched.push_schedule(f.name(), 0, "pad_storage(" + var + ")", {var});
+                return;
+            }
+        }
+        return;
+    }
+}
+
 void Partitioner::generate_group_cpu_schedule(
         const Group &g, const Target &t,
         const map<FStage, DimBounds> &group_loop_bounds,
@@ -2694,6 +3296,17 @@ void Partitioner::generate_group_cpu_schedule(
     } else {
         Func(g_out).compute_root();
         sched.push_schedule(f_handle.name(), g.output.stage_num, "compute_root()", {});
+
+        // The storage of the pipeline outputs isn't ours to pad.
+        bool is_output = false;
+        for (const Function &o : outputs) {
+            is_output = is_output || (o.name() == g_out.name());
+        }
+        const auto &iter = pipeline_bounds.find(g_out.name());
+        if (!is_output && !g_out.has_extern_definition() &&
+            (iter != pipeline_bounds.end())) {
+            pad_storage(g_out, iter->second, sched);
+        }
     }
 
     if (g.output.func.has_extern_definition()) {
@@ -2701,6 +3314,21 @@ void Partitioner::generate_group_cpu_schedule(
         return;
     }
 
+    // Large reductions without enough pure parallelism are rfactored into a
+    // parallel intermediate function instead of being tiled.
+    if ((g.output.stage_num > 0) &&
+        rfactor_stage(g, f_handle, def, stg_estimates, sched)) {
+        return;
+    }
+
+    // Matrix multiplies get a register-blocked micro-kernel instead of the
+    // generic tiling, when the target will keep the accumulators in
+    // registers.
+    if ((g.output.stage_num > 0) && t.has_feature(Target::AccumulateInRegisters) &&
+        register_tile_stage(g, f_handle, def, stg_estimates, t, sched)) {
+        return;
+    }
+
     // Realize tiling and update the dimension estimates
     vector<VarOrRVar> outer_dims;
     vector<VarOrRVar> inner_dims;
@@ -2724,7 +3352,7 @@ void Partitioner::generate_group_cpu_schedule(
         map<string, Expr> strides =
             analyze_spatial_locality(g.output, group_storage_bounds, inlines);
         if (!strides.empty()) {
-            reorder_dims(f_handle, g.output.stage_num, def, strides, sched);
+            reorder_dims(f_handle, g.output.stage_num, def, g.output.func, strides, sched);
         }
     }
 
@@ -2850,6 +3478,11 @@ void Partitioner::generate_group_cpu_schedule(
         user_warning << "Insufficient parallelism for " << f_handle.name() << '\n';
     }
 
+    if (auto_schedule_prefetch()) {
+        prefetch_stage(g, g.output, f_handle, group_storage_bounds, inlines,
+                       stg_estimates, sched);
+    }
+
     // Find the level at which group members will be computed.
     int tile_inner_index = dims.size() - outer_dims.size() - 1;
     VarOrRVar tile_inner_var("", false);
@@ -2898,6 +3531,10 @@ void Partitioner::generate_group_cpu_schedule(
                 sched.push_schedule(mem_handle.name(), mem.stage_num,
                                     "compute_at(" + sanitized_g_out + ", " + tile_inner_var.name() + ")",
                                     {sanitized_g_out, tile_inner_var.name()});
+                const auto &iter = group_storage_bounds.find(mem.func.name());
+                if (iter != group_storage_bounds.end()) {
+                    pad_storage(mem.func, iter->second, sched);
+                }
             } else {
                 user_warning << "Degenerate tiling. No dimensions are tiled" << '\n';
                 user_warning << "Computing \"" <<  mem.func.name() << "\" at root" << '\n';
@@ -2912,12 +3549,17 @@ void Partitioner::generate_group_cpu_schedule(
             map<string, Expr> mem_strides =
                 analyze_spatial_locality(mem, group_storage_bounds, inlines);
             if (!mem_strides.empty()) {
-                reorder_dims(mem_handle, mem.stage_num, mem_def, mem_strides, sched);
+                reorder_dims(mem_handle, mem.stage_num, mem_def, mem.func, mem_strides, sched);
             }
         }
 
         vectorize_stage(g, mem_handle, mem.stage_num, mem_def, mem.func, false,
                         t, mem_rvars, mem_estimates, sched);
+
+        if (auto_schedule_prefetch()) {
+            prefetch_stage(g, mem, mem_handle, group_storage_bounds, inlines,
+                           mem_estimates, sched);
+        }
     }
 }
 
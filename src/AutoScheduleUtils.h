@@ -31,6 +31,9 @@ class FindAllCalls : public IRVisitor {
             funcs_called.insert(call->name);
             call_args.push_back(std::make_pair(call->name, call->args));
         }
+        if (call->call_type == Call::Image && call->param.defined()) {
+            image_params.emplace(call->name, call->param);
+        }
         for (size_t i = 0; i < call->args.size(); i++) {
             call->args[i].accept(this);
         }
@@ -38,6 +41,7 @@ class FindAllCalls : public IRVisitor {
 public:
     std::set<std::string> funcs_called;
     std::vector<std::pair<std::string, std::vector<Expr>>> call_args;
+    std::map<std::string, Parameter> image_params;
 };
 
 
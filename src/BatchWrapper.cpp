@@ -0,0 +1,168 @@
+#include "BatchWrapper.h"
+#include "IROperator.h"
+#include "Argument.h"
+
+namespace Halide {
+namespace Internal {
+
+using std::pair;
+using std::string;
+using std::vector;
+
+namespace {
+
+// Make a call and return the result upwards immediately if it's
+// non-zero. The called function has already reported the error.
+Stmt make_checked_call(Expr call) {
+    internal_assert(call.type() == Int(32));
+    string result_var_name = unique_name('t');
+    Expr result_var = Variable::make(Int(32), result_var_name);
+    Stmt s = AssertStmt::make(result_var == 0, result_var);
+    s = LetStmt::make(result_var_name, call, s);
+    return s;
+}
+
+Stmt make_lets(vector<pair<string, Expr>> lets, Stmt s) {
+    while (!lets.empty()) {
+        s = LetStmt::make(lets.back().first, lets.back().second, s);
+        lets.pop_back();
+    }
+    return s;
+}
+
+}  // namespace
+
+void add_batch_wrapper(Module module, const LoweredFunc &fn, const string &unchecked_fn_name) {
+    // type_of() only knows about one level of pointers.
+    static const halide_handle_cplusplus_type buffer_array_info{
+        halide_cplusplus_type_name(halide_cplusplus_type_name::Struct, "halide_buffer_t"),
+        {}, {}, {halide_handle_cplusplus_type::Pointer, halide_handle_cplusplus_type::Pointer}};
+    const Type buffer_type = type_of<struct halide_buffer_t *>();
+    const Type buffer_array_type = Handle(1, &buffer_array_info);
+
+    const string batch_size_name = "__batch_size";
+    const string index_name = fn.name + ".batch_index";
+    Expr batch_size = Variable::make(Int(32), batch_size_name);
+    Expr index = Variable::make(Int(32), index_name);
+
+    // Build the arguments to the wrapper, and the arguments to pass
+    // for the first image and for the rest of them.
+    vector<LoweredArgument> args;
+    vector<Expr> first_args, item_args;
+    vector<pair<string, Expr>> first_lets, item_lets;
+    vector<Stmt> item_checks;
+    Expr any_bounds_query = const_false();
+    for (const LoweredArgument &arg : fn.args) {
+        if (!arg.is_buffer()) {
+            args.push_back(arg);
+            Expr var = Variable::make(arg.type, arg.name);
+            first_args.push_back(var);
+            item_args.push_back(var);
+            if (arg.name == "__user_context") {
+                args.emplace_back(batch_size_name, Argument::InputScalar, Int(32), 0);
+            }
+            continue;
+        }
+
+        // Buffer arguments become arrays of buffers.
+        args.emplace_back(arg.name, Argument::InputScalar, buffer_array_type, 0);
+
+        string first_name = arg.name + ".batch_first";
+        Expr first = Variable::make(buffer_type, first_name);
+        first_lets.push_back({first_name, Load::make(buffer_type, arg.name, 0,
+                                                     Buffer<>(), Parameter(), const_true())});
+        first_args.push_back(first);
+
+        string item_name = arg.name + ".batch_item";
+        Expr item = Variable::make(buffer_type, item_name);
+        item_lets.push_back({item_name, Load::make(buffer_type, arg.name, index,
+                                                   Buffer<>(), Parameter(), const_true())});
+        item_args.push_back(item);
+
+        any_bounds_query = any_bounds_query ||
+            Call::make(Bool(), Call::buffer_is_bounds_query, {first}, Call::Extern);
+
+        // The unchecked function trusts that the buffers for the other
+        // images are valid, which they are if they have the same type
+        // and shape as the ones for the first image.
+        string error_name = (arg.is_output() ? "Output" : "Input");
+        error_name += " buffer " + arg.name;
+        Expr type_code = Call::make(UInt(8), Call::buffer_get_type_code, {item}, Call::Extern);
+        Expr type_bits = Call::make(UInt(8), Call::buffer_get_type_bits, {item}, Call::Extern);
+        Expr type_lanes = Call::make(UInt(16), Call::buffer_get_type_lanes, {item}, Call::Extern);
+        Expr type_error = Call::make(Int(32), "halide_error_bad_type",
+                                     {error_name,
+                                      type_code, make_const(UInt(8), (int)arg.type.code()),
+                                      type_bits, make_const(UInt(8), arg.type.bits()),
+                                      type_lanes, make_const(UInt(16), arg.type.lanes())},
+                                     Call::Extern);
+        item_checks.push_back(AssertStmt::make((type_code == arg.type.code()) &&
+                                               (type_bits == arg.type.bits()) &&
+                                               (type_lanes == arg.type.lanes()), type_error));
+
+        // Without a device API, the unchecked function reads the host
+        // memory without copying it back from a device first, so each
+        // item must have a host allocation wherever the first image
+        // does, and must not be dirty on a device.
+        if (!module.target().has_gpu_feature()) {
+            Expr item_host = Call::make(Handle(), Call::buffer_get_host, {item}, Call::Extern);
+            Expr first_host = Call::make(Handle(), Call::buffer_get_host, {first}, Call::Extern);
+            Expr host_error = Call::make(Int(32), "halide_error_host_is_null",
+                                         {error_name}, Call::Extern);
+            item_checks.push_back(AssertStmt::make(first_host == make_zero(Handle()) ||
+                                                   item_host != make_zero(Handle()), host_error));
+
+            Expr device_dirty = Call::make(Bool(), Call::buffer_get_device_dirty, {item}, Call::Extern);
+            Expr dirty_error = Call::make(Int(32), "halide_error_device_dirty_with_no_device_support",
+                                          {error_name}, Call::Extern);
+            item_checks.push_back(AssertStmt::make(!device_dirty, dirty_error));
+        }
+
+        const Call::ConstString fields[] = {Call::buffer_get_min,
+                                            Call::buffer_get_extent,
+                                            Call::buffer_get_stride};
+        const char *field_names[] = {".min.", ".extent.", ".stride."};
+        for (int d = 0; d < arg.dimensions; d++) {
+            for (int f = 0; f < 3; f++) {
+                string suffix = field_names[f] + std::to_string(d);
+                Expr actual = Call::make(Int(32), fields[f], {item, d}, Call::Extern);
+                Expr expected = Call::make(Int(32), fields[f], {first, d}, Call::Extern);
+                Expr error = Call::make(Int(32), "halide_error_constraint_violated",
+                                        {arg.name + suffix, actual,
+                                         arg.name + "[0]" + suffix, expected},
+                                        Call::Extern);
+                item_checks.push_back(AssertStmt::make(actual == expected, error));
+            }
+        }
+    }
+    if (args.size() == fn.args.size()) {
+        // There was no user context to put the batch size after.
+        args.insert(args.begin(), LoweredArgument(batch_size_name, Argument::InputScalar, Int(32), 0));
+    }
+
+    Call::CallType call_type = Call::Extern;
+    if (fn.name_mangling == NameMangling::CPlusPlus ||
+        (fn.name_mangling == NameMangling::Default &&
+         module.target().has_feature(Target::CPlusPlusMangling))) {
+        call_type = Call::ExternCPlusPlus;
+    }
+
+    // Run the rest of the images in parallel, skipping the argument
+    // checks and bounds queries that the first image already did.
+    item_checks.push_back(make_checked_call(Call::make(Int(32), unchecked_fn_name, item_args, call_type)));
+    Stmt items = make_lets(item_lets, Block::make(item_checks));
+    items = For::make(index_name, 1, batch_size - 1, ForType::Parallel, DeviceAPI::None, items);
+
+    // If the first image was a bounds query, that's all we do.
+    Stmt body = Block::make(make_checked_call(Call::make(Int(32), fn.name, first_args, call_type)),
+                            IfThenElse::make(batch_size > 1 && !any_bounds_query, items));
+    body = make_lets(first_lets, body);
+    body = IfThenElse::make(batch_size > 0, body);
+
+    debug(2) << "Added batch wrapper for " << fn.name << ":\n" << body << "\n\n";
+    LoweredFunc wrapper(fn.name + "_batch", args, body, LoweredFunc::External, NameMangling::Default);
+    module.append(wrapper);
+}
+
+}
+}
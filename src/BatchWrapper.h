@@ -0,0 +1,34 @@
+#ifndef HALIDE_BATCH_WRAPPER_H
+#define HALIDE_BATCH_WRAPPER_H
+
+/** \file
+ *
+ * Defines the entry point added to a Module for the batch target feature.
+ */
+
+#include "Module.h"
+
+namespace Halide {
+namespace Internal {
+
+/** Add a function named fn.name + "_batch" to the module, which runs
+ * fn over a batch of images. It takes the same arguments as fn, except
+ * that it takes the number of images (as an int32_t named __batch_size,
+ * after the user context if there is one), and each buffer argument
+ * becomes an array of halide_buffer_t pointers with one entry per
+ * image. Scalar arguments are shared by all the images.
+ *
+ * The first image is run with fn itself, which checks all of the
+ * arguments. The rest are run in parallel with the function named
+ * unchecked_fn_name, which must have the same signature as fn but may
+ * skip argument checks and bounds queries; each of their buffers is
+ * only checked to have the same type and shape as the corresponding
+ * buffer of the first image and, for targets without a GPU feature, to
+ * have host memory and no dirty device memory. The unchecked function
+ * must already be in the module. */
+void add_batch_wrapper(Module m, const LoweredFunc &fn, const std::string &unchecked_fn_name);
+
+}
+}
+
+#endif
@@ -1135,6 +1135,180 @@ class SolveIfThenElse : public IRMutator2 {
     }
 };
 
+// Strip out the parts of a Stmt that can't contribute to the box
+// touched of a single Func. Bounds inference on the remaining Stmt
+// gives the same answer, but BoxesTouched no longer has to compute
+// bounds of every let and loop in the Stmt. This matters for
+// allocation bounds inference, which asks for the box touched of
+// every realization over its entire (potentially huge) body.
+class TrimStmtToPartsThatTouch : public IRMutator2 {
+    const string &func;
+    bool consider_calls, consider_provides;
+
+    class Touches : public IRGraphVisitor {
+        using IRGraphVisitor::visit;
+
+        const string &func;
+        bool consider_calls, consider_provides;
+
+        void visit(const Call *op) {
+            if (consider_calls && op->name == func) {
+                result = true;
+            } else {
+                IRGraphVisitor::visit(op);
+            }
+        }
+
+        void visit(const Provide *op) {
+            if (consider_provides && op->name == func) {
+                result = true;
+            } else {
+                IRGraphVisitor::visit(op);
+            }
+        }
+
+    public:
+        bool result = false;
+        Touches(const string &f, bool calls, bool provides) :
+            func(f), consider_calls(calls), consider_provides(provides) {}
+    };
+
+    template<typename T>
+    bool touches(const T &ir) {
+        if (!ir.defined()) {
+            return false;
+        }
+        Touches t(func, consider_calls, consider_provides);
+        ir.accept(&t);
+        return t.result;
+    }
+
+    template<typename StmtOrExpr>
+    bool touches_any(const vector<StmtOrExpr> &v) {
+        for (const StmtOrExpr &i : v) {
+            if (touches(i)) return true;
+        }
+        return false;
+    }
+
+    bool touches(const Region &bounds) {
+        for (const Range &r : bounds) {
+            if (touches(r.min) || touches(r.extent)) return true;
+        }
+        return false;
+    }
+
+    template<typename T>
+    Stmt trim_leaf(const T *op) {
+        Stmt s = op;
+        return touches(s) ? s : Evaluate::make(0);
+    }
+
+    using IRMutator2::visit;
+
+    Stmt visit(const AssertStmt *op) override { return trim_leaf(op); }
+    Stmt visit(const Store *op) override { return trim_leaf(op); }
+    Stmt visit(const Provide *op) override { return trim_leaf(op); }
+    Stmt visit(const Free *op) override { return trim_leaf(op); }
+    Stmt visit(const Evaluate *op) override { return trim_leaf(op); }
+    Stmt visit(const Prefetch *op) override { return trim_leaf(op); }
+
+    Stmt visit(const LetStmt *op) override {
+        Stmt body = mutate(op->body);
+        if (is_no_op(body) && !touches(op->value)) {
+            return body;
+        } else if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return LetStmt::make(op->name, op->value, body);
+        }
+    }
+
+    Stmt visit(const For *op) override {
+        Stmt body = mutate(op->body);
+        if (is_no_op(body) &&
+            !(consider_calls && (touches(op->min) || touches(op->extent)))) {
+            return body;
+        } else if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return For::make(op->name, op->min, op->extent, op->for_type, op->device_api, body);
+        }
+    }
+
+    Stmt visit(const ProducerConsumer *op) override {
+        Stmt body = mutate(op->body);
+        if (is_no_op(body)) {
+            return body;
+        } else if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return ProducerConsumer::make(op->name, op->is_producer, body);
+        }
+    }
+
+    Stmt visit(const Realize *op) override {
+        Stmt body = mutate(op->body);
+        if (is_no_op(body) && !touches(op->bounds) && !touches(op->condition)) {
+            return body;
+        } else if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return Realize::make(op->name, op->types, op->bounds, op->condition, body);
+        }
+    }
+
+    Stmt visit(const Allocate *op) override {
+        Stmt body = mutate(op->body);
+        if (is_no_op(body) && !touches_any(op->extents) &&
+            !touches(op->condition) && !touches(op->new_expr)) {
+            return body;
+        } else if (body.same_as(op->body)) {
+            return op;
+        } else {
+            return Allocate::make(op->name, op->type, op->extents, op->condition,
+                                  body, op->new_expr, op->free_function);
+        }
+    }
+
+    Stmt visit(const Block *op) override {
+        Stmt first = mutate(op->first);
+        Stmt rest = mutate(op->rest);
+        if (is_no_op(first)) {
+            return rest;
+        } else if (is_no_op(rest)) {
+            return first;
+        } else if (first.same_as(op->first) && rest.same_as(op->rest)) {
+            return op;
+        } else {
+            return Block::make(first, rest);
+        }
+    }
+
+    Stmt visit(const IfThenElse *op) override {
+        Stmt then_case = mutate(op->then_case);
+        Stmt else_case = mutate(op->else_case);
+        if (is_no_op(then_case) && is_no_op(else_case) && !touches(op->condition)) {
+            return then_case;
+        }
+        // BoxesTouched treats an if with no else case differently
+        // from one with an else case, so don't trim an else case
+        // away entirely.
+        if (op->else_case.defined() && !is_no_op(op->else_case) && is_no_op(else_case)) {
+            else_case = op->else_case;
+        }
+        if (then_case.same_as(op->then_case) && else_case.same_as(op->else_case)) {
+            return op;
+        } else {
+            return IfThenElse::make(op->condition, then_case, else_case);
+        }
+    }
+
+public:
+    TrimStmtToPartsThatTouch(const string &f, bool calls, bool provides) :
+        func(f), consider_calls(calls), consider_provides(provides) {}
+};
+
 // Collect all variables referenced in an expr or statement
 // (excluding 'skipped_var')
 class CollectVars : public IRGraphVisitor {
@@ -1195,6 +1369,33 @@ private:
     // Map variable name to all other vars which values depend on that variable.
     map<VarInstance, set<VarInstance>> children;
 
+    // Identifies the current contents of the scope, for the arg_bounds
+    // cache. Every push gets a fresh state. The bindings made with
+    // ScopedValue return to the enclosing state when they go out of
+    // scope, which is safe because they are strictly nested. The
+    // pushes and pops in trim_scope_push and trim_scope_pop are not
+    // saved anywhere, so each of those pops also takes a fresh state
+    // rather than trying to restore one; reusing a state whose scope
+    // contents differ would return stale bounds from the cache.
+    int scope_state = 0, next_scope_state = 1;
+
+    // The bounds of the args of calls and provides, keyed on the arg
+    // and the scope state they were computed in. Stencils access the
+    // same arg Exprs many times within a loop body, and each access
+    // would otherwise redo the same bounds query. The Expr is kept
+    // alive so that its address can't be reused by another node.
+    map<pair<const IRNode *, int>, pair<Expr, Interval>> arg_bounds;
+
+    Interval bounds_of_arg(const Expr &e) {
+        auto key = std::make_pair(e.get(), scope_state);
+        auto iter = arg_bounds.find(key);
+        if (iter == arg_bounds.end()) {
+            Interval i = bounds_of_expr_in_scope(e, scope, func_bounds);
+            iter = arg_bounds.emplace(key, std::make_pair(e, i)).first;
+        }
+        return iter->second.second;
+    }
+
     using IRGraphVisitor::visit;
 
     void visit(const Call *op) {
@@ -1222,7 +1423,7 @@ private:
                 Box b(op->args.size());
                 b.used = const_true();
                 for (size_t i = 0; i < op->args.size(); i++) {
-                    b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds);
+                    b[i] = bounds_of_arg(op->args[i]);
                 }
                 merge_boxes(boxes[op->name], b);
             }
@@ -1290,6 +1491,7 @@ private:
         if (is_small_enough_to_substitute(value_bounds.min) &&
             (fixed || is_small_enough_to_substitute(value_bounds.max))) {
             ScopedBinding<Interval> p(scope, op->name, value_bounds);
+            ScopedValue<int> s(scope_state, next_scope_state++);
             op->body.accept(this);
         } else {
             string max_name = unique_name('t');
@@ -1297,6 +1499,7 @@ private:
             {
                 ScopedBinding<Interval> p(scope, op->name, Interval(Variable::make(op->value.type(), min_name),
                                                                 Variable::make(op->value.type(), max_name)));
+                ScopedValue<int> s(scope_state, next_scope_state++);
                 op->body.accept(this);
             }
 
@@ -1390,6 +1593,7 @@ private:
 
     void trim_scope_push(const string &name, const Interval &bound, vector<LetBound> &let_bounds) {
         scope.push(name, bound);
+        scope_state = next_scope_state++;
 
         for (const auto &v : children[get_var_instance(name)]) {
             string max_name = unique_name('t');
@@ -1452,6 +1656,7 @@ private:
             }
         }
         scope.pop(name);
+        scope_state = next_scope_state++;
     }
 
     void visit(const IfThenElse *op) {
@@ -1634,6 +1839,7 @@ private:
         push_var(op->name);
         {
             ScopedBinding<Interval> p(scope, op->name, Interval(min_val, max_val));
+            ScopedValue<int> s(scope_state, next_scope_state++);
             op->body.accept(this);
         }
         pop_var(op->name);
@@ -1644,7 +1850,7 @@ private:
             if (op->name == func || func.empty()) {
                 Box b(op->args.size());
                 for (size_t i = 0; i < op->args.size(); i++) {
-                    b[i] = bounds_of_expr_in_scope(op->args[i], scope, func_bounds);
+                    b[i] = bounds_of_arg(op->args[i]);
                 }
                 merge_boxes(boxes[op->name], b);
             }
@@ -1663,6 +1869,16 @@ private:
 
 map<string, Box> boxes_touched(Expr e, Stmt s, bool consider_calls, bool consider_provides,
                                string fn, const Scope<Interval> &scope, const FuncValueBounds &fb) {
+    if (!fn.empty() && s.defined()) {
+        s = TrimStmtToPartsThatTouch(fn, consider_calls, consider_provides).mutate(s);
+        if (is_no_op(s)) {
+            s = Stmt();
+        }
+        if (!e.defined() && !s.defined()) {
+            return map<string, Box>();
+        }
+    }
+
     // Move the innermost vars in an IfThenElse's condition as far to the left
     // as possible, so that BoxesTouched can prune the variable scope tighter
     // when encountering the IfThenElse.
@@ -1906,25 +2122,7 @@ void constant_bound_test() {
                          Interval::neg_inf, Interval::pos_inf);
 }
 
-void boxes_touched_test() {
-    Type t = Int(32);
-    Expr x = Variable::make(t, "x");
-    Expr y = Variable::make(t, "y");
-    Expr z = Variable::make(t, "z");
-    Expr w = Variable::make(t, "w");
-
-    Scope<Interval> scope;
-    scope.push("y", Interval(Expr(0), Expr(10)));
-
-    Stmt stmt = Provide::make("f", {10}, {x, y, z, w});
-    stmt = IfThenElse::make(y > 4, stmt, Stmt());
-    stmt = IfThenElse::make(z > 18, stmt, Stmt());
-    stmt = LetStmt::make("w", z + 3, stmt);
-    stmt = LetStmt::make("z", x + 2, stmt);
-    stmt = LetStmt::make("x", y + 10, stmt);
-
-    Box expected({Interval(15, 20), Interval(5, 10), Interval(19, 22), Interval(22, 25)});
-    Box result = box_provided(stmt, "f", scope);
+void check_box(const Box &result, const Box &expected) {
     internal_assert(expected.size() == result.size())
         << "Expect dim size of " << expected.size()
         << ", got " << result.size() << " instead\n";
@@ -1946,6 +2144,35 @@ void boxes_touched_test() {
     }
 }
 
+void boxes_touched_test() {
+    Type t = Int(32);
+    Expr x = Variable::make(t, "x");
+    Expr y = Variable::make(t, "y");
+    Expr z = Variable::make(t, "z");
+    Expr w = Variable::make(t, "w");
+
+    Scope<Interval> scope;
+    scope.push("y", Interval(Expr(0), Expr(10)));
+
+    Stmt stmt = Provide::make("f", {10}, {x, y, z, w});
+    stmt = IfThenElse::make(y > 4, stmt, Stmt());
+    stmt = IfThenElse::make(z > 18, stmt, Stmt());
+    stmt = LetStmt::make("w", z + 3, stmt);
+    stmt = LetStmt::make("z", x + 2, stmt);
+    stmt = LetStmt::make("x", y + 10, stmt);
+
+    Box expected({Interval(15, 20), Interval(5, 10), Interval(19, 22), Interval(22, 25)});
+    check_box(box_provided(stmt, "f", scope), expected);
+
+    // Parts of the Stmt that don't touch f shouldn't change its box.
+    Stmt other = Provide::make("g", {x}, {w});
+    other = For::make("w", 0, 100, ForType::Serial, DeviceAPI::None, other);
+    other = LetStmt::make("x", y * 3, other);
+    stmt = Block::make(other, stmt);
+    check_box(box_provided(stmt, "f", scope), expected);
+    check_box(box_provided(stmt, "g", scope), Box({Interval(0, 99)}));
+}
+
 } // anonymous namespace
 
 void bounds_test() {
@@ -1002,4 +1002,19 @@ int CodeGen_ARM::native_vector_bits() const {
     return 128;
 }
 
+int CodeGen_ARM::max_loop_carried_values() const {
+    // Depending on the cache and the number of load ports, reloading
+    // can be cheaper, so this is opt-in.
+    if (!target.has_feature(Target::LoopCarry)) {
+        return 0;
+    }
+    // Use at most half of the vector registers for carrying values:
+    // AArch64 has 32 of them, ARMv7 NEON has 16.
+    if (target.bits == 64) {
+        return 16;
+    } else {
+        return 8;
+    }
+}
+
 }}
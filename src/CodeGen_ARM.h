@@ -67,6 +67,7 @@ protected:
     std::string mattrs() const;
     bool use_soft_float_abi() const;
     int native_vector_bits() const;
+    int max_loop_carried_values() const;
 
     // NEON can be disabled for older processors.
     bool neon_intrinsics_disabled() {
@@ -2402,7 +2402,11 @@ void CodeGen_C::visit(const Load *op) {
         string id_index = print_expr(op->index);
         bool type_cast_needed = !(allocations.contains(op->name) &&
                               allocations.get(op->name).type.element_of() == t.element_of());
-        if (type_cast_needed) {
+        if (type_cast_needed && t.is_handle()) {
+            // Loading a pointer (e.g. from an array of buffers): the
+            // thing loaded is const, not what it points to.
+            rhs << "((" << print_type(t.element_of()) << " const *)" << name << ")";
+        } else if (type_cast_needed) {
             rhs << "((const " << print_type(t.element_of()) << " *)" << name << ")";
         } else {
             rhs << name;
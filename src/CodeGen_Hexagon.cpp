@@ -213,8 +213,7 @@ void CodeGen_Hexagon::compile_func(const LoweredFunc &f,
     debug(2) << "Lowering after aligning loads:\n" << body << "\n\n";
 
     debug(1) << "Carrying values across loop iterations...\n";
-    // Use at most 16 vector registers for carrying values.
-    body = loop_carry(body, 16);
+    body = loop_carry(body, max_loop_carried_values());
     body = simplify(body);
     debug(2) << "Lowering after forwarding stores:\n" << body << "\n\n";
 
@@ -1520,6 +1519,11 @@ int CodeGen_Hexagon::native_vector_bits() const {
     }
 }
 
+int CodeGen_Hexagon::max_loop_carried_values() const {
+    // Use at most 16 vector registers for carrying values.
+    return 16;
+}
+
 void CodeGen_Hexagon::visit(const Add *op) {
     if (op->type.is_vector()) {
         value = call_intrin(op->type,
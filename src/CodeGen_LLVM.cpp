@@ -7,12 +7,14 @@
 #include "CodeGen_LLVM.h"
 #include "CPlusPlusMangle.h"
 #include "IROperator.h"
+#include "IRVisitor.h"
 #include "Debug.h"
 #include "Deinterleave.h"
 #include "Simplify.h"
 #include "JITModule.h"
 #include "CodeGen_Internal.h"
 #include "Lerp.h"
+#include "LoopCarry.h"
 #include "Util.h"
 #include "LLVM_Runtime_Linker.h"
 #include "MatlabWrapper.h"
@@ -250,7 +252,9 @@ CodeGen_LLVM::CodeGen_LLVM(Target t) :
 
     min_f64(Float(64).min()),
     max_f64(Float(64).max()),
-    destructor_block(nullptr) {
+    destructor_block(nullptr),
+    nontemporal_stores_emitted(false),
+    in_cpu_dispatch_loop(false) {
     initialize_llvm();
 }
 
@@ -688,9 +692,24 @@ void CodeGen_LLVM::compile_func(const LoweredFunc &f, const std::string &simple_
         }
     }
 
+    Stmt body = f.body;
+    int max_carried_values = max_loop_carried_values();
+    if (max_carried_values > 0) {
+        debug(1) << "Carrying values across loop iterations...\n";
+        body = loop_carry(body, max_carried_values);
+        if (!body.same_as(f.body)) {
+            body = simplify(body);
+            debug(2) << "Lowering after carrying values across loop iterations:\n" << body << "\n\n";
+        }
+    }
+
      // Generate the function body.
     debug(1) << "Generating llvm bitcode for function " << f.name << "...\n";
-    f.body.accept(this);
+    nontemporal_stores_emitted = false;
+    body.accept(this);
+    if (nontemporal_stores_emitted) {
+        builder->CreateFence(AtomicOrdering::SequentiallyConsistent);
+    }
 
     // Clean up and return.
     end_func(f.args);
@@ -2746,6 +2765,60 @@ void CodeGen_LLVM::visit(const Call *op) {
         internal_assert(op->args.size() == 1);
         Expr e = Internal::halide_exp(op->args[0]);
         e.accept(this);
+    } else if (op->call_type == Call::PureExtern && op->type.is_vector() &&
+               (op->name == "log_f64" || op->name == "exp_f64")) {
+        // Vectors of these would otherwise be scalarized into libm
+        // calls. Scalars still call libm.
+        internal_assert(op->args.size() == 1);
+        Expr e;
+        if (op->name == "log_f64") {
+            e = Internal::halide_log(op->args[0]);
+        } else {
+            e = Internal::halide_exp(op->args[0]);
+        }
+        e.accept(this);
+    } else if (op->call_type == Call::PureExtern && op->type.is_vector() &&
+               (op->name == "sin_f32" || op->name == "sin_f64" ||
+                op->name == "cos_f32" || op->name == "cos_f64")) {
+        // Use the polynomial approximation if every lane is small
+        // enough for its range reduction to be accurate. Otherwise
+        // (including for infinities and NaNs), call libm for each lane
+        // like the scalar version does.
+        internal_assert(op->args.size() == 1);
+        string x_name = unique_name('x');
+        sym_push(x_name, codegen(op->args[0]));
+        Expr x = Variable::make(op->args[0].type(), x_name);
+
+        Expr max_x = make_const(x.type(), Internal::halide_sin_cos_max_argument(x.type()));
+        Value *in_range = codegen(abs(x) <= max_x);
+        llvm::Type *mask_t = llvm::IntegerType::get(*context, op->type.lanes());
+        Value *all_in_range = builder->CreateICmpEQ(builder->CreateBitCast(in_range, mask_t),
+                                                    ConstantInt::getAllOnesValue(mask_t));
+
+        BasicBlock *fast_bb = BasicBlock::Create(*context, "fast " + op->name, function);
+        BasicBlock *libm_bb = BasicBlock::Create(*context, "libm " + op->name, function);
+        BasicBlock *after_bb = BasicBlock::Create(*context, "after " + op->name, function);
+        builder->CreateCondBr(all_in_range, fast_bb, libm_bb, very_likely_branch);
+
+        builder->SetInsertPoint(fast_bb);
+        Expr e = starts_with(op->name, "sin") ? Internal::halide_sin(x) : Internal::halide_cos(x);
+        Value *fast_value = codegen(e);
+        builder->CreateBr(after_bb);
+        BasicBlock *fast_pred = builder->GetInsertBlock();
+
+        builder->SetInsertPoint(libm_bb);
+        scalarize(Call::make(op->type, op->name, {x}, Call::PureExtern));
+        Value *libm_value = value;
+        builder->CreateBr(after_bb);
+        BasicBlock *libm_pred = builder->GetInsertBlock();
+
+        builder->SetInsertPoint(after_bb);
+        PHINode *phi = builder->CreatePHI(fast_value->getType(), 2);
+        phi->addIncoming(fast_value, fast_pred);
+        phi->addIncoming(libm_value, libm_pred);
+        value = phi;
+
+        sym_pop(x_name);
     } else if (op->call_type == Call::PureExtern &&
                (op->name == "is_nan_f32" || op->name == "is_nan_f64")) {
         internal_assert(op->args.size() == 1);
@@ -3024,7 +3097,178 @@ void CodeGen_LLVM::visit(const ProducerConsumer *op) {
     codegen(op->body);
 }
 
+namespace {
+// Finds loops that contain vector loads or stores.
+class IsCPUDispatchCandidate : public IRVisitor {
+    using IRVisitor::visit;
+
+    void visit(const Load *op) {
+        has_vectors = has_vectors || op->type.is_vector();
+        IRVisitor::visit(op);
+    }
+
+    void visit(const Store *op) {
+        has_vectors = has_vectors || op->value.type().is_vector();
+        IRVisitor::visit(op);
+    }
+
+public:
+    bool has_vectors = false;
+};
+}
+
+void CodeGen_LLVM::set_cpu_dispatch_attributes(llvm::Function *fn) {
+    fn->addFnAttr("target-cpu", mcpu());
+    fn->addFnAttr("target-features", mattrs());
+}
+
+void CodeGen_LLVM::codegen_cpu_dispatch(const For *op, const vector<Target> &targets) {
+    debug(3) << "Compiling " << targets.size() << " extra versions of loop over " << op->name << "\n";
+
+    // Find every symbol that the loop refers to and dump it into a
+    // closure, as for a parallel loop.
+    Closure closure(op);
+    StructType *closure_t = build_closure_type(closure, buffer_t_type, context);
+    Value *closure_ptr = create_alloca_at_entry(closure_t, 1);
+    Value *user_context = get_user_context();
+
+    // Make one function per target, which runs the whole loop.
+    llvm::Type *voidPointerType = (llvm::Type *)(i8_t->getPointerTo());
+    llvm::Type *args_t[] = {voidPointerType, voidPointerType};
+    FunctionType *func_t = FunctionType::get(i32_t, args_t, false);
+    vector<llvm::Function *> versions;
+    for (const Target &t : targets) {
+        llvm::Function *containing_function = function;
+        Target base_target = target;
+        target = t;
+        function = llvm::Function::Create(func_t, llvm::Function::InternalLinkage,
+                                          containing_function->getName() + "_" + op->name + "_" + mcpu(),
+                                          module.get());
+        set_function_attributes_for_target(function, target);
+        set_cpu_dispatch_attributes(function);
+        // It can't be inlined into code for the base target anyway.
+        function->addFnAttr(Attribute::NoInline);
+        versions.push_back(function);
+
+        IRBuilderBase::InsertPoint call_site = builder->saveIP();
+        BasicBlock *block = BasicBlock::Create(*context, "entry", function);
+        builder->SetInsertPoint(block);
+
+        BasicBlock *parent_destructor_block = destructor_block;
+        destructor_block = nullptr;
+
+        Scope<Value *> saved_symbol_table;
+        symbol_table.swap(saved_symbol_table);
+
+        // The user context is the first argument, and the closure the second.
+        llvm::Function::arg_iterator iter = function->arg_begin();
+        sym_push("__user_context", iterator_to_pointer(iter));
+        ++iter;
+        iter->setName("closure");
+        Value *closure_handle = builder->CreatePointerCast(iterator_to_pointer(iter),
+                                                           closure_t->getPointerTo());
+        unpack_closure(closure, symbol_table, closure_t, closure_handle, builder);
+
+        in_cpu_dispatch_loop = true;
+        op->accept(this);
+        in_cpu_dispatch_loop = false;
+
+        return_with_error_code(ConstantInt::get(i32_t, 0));
+
+        builder->restoreIP(call_site);
+        symbol_table.swap(saved_symbol_table);
+        function = containing_function;
+        destructor_block = parent_destructor_block;
+        target = base_target;
+    }
+
+    // Pick a version the first time through, and remember it for the
+    // rest of the module. targets.size() means the base target. Other
+    // threads may be doing the same thing, but they all pick the same
+    // version, so relaxed atomics are enough.
+    GlobalVariable *chosen_version = module->getNamedGlobal("cpu_dispatch_version");
+    if (!chosen_version) {
+        chosen_version = new GlobalVariable(*module, i32_t, false, GlobalValue::InternalLinkage,
+                                            ConstantInt::get(i32_t, -1), "cpu_dispatch_version");
+    }
+    LoadInst *cached = builder->CreateLoad(chosen_version);
+    cached->setAtomic(AtomicOrdering::Monotonic);
+    cached->setAlignment(4);
+    BasicBlock *cached_bb = builder->GetInsertBlock();
+    BasicBlock *choose_bb = BasicBlock::Create(*context, "choose version of " + op->name, function);
+    BasicBlock *dispatch_bb = BasicBlock::Create(*context, "dispatch " + op->name, function);
+    Value *known = builder->CreateICmpSGE(cached, ConstantInt::get(i32_t, 0));
+    builder->CreateCondBr(known, dispatch_bb, choose_bb, very_likely_branch);
+
+    builder->SetInsertPoint(choose_bb);
+    Expr choice = make_const(Int(32), (int)targets.size());
+    for (int i = (int)targets.size() - 1; i >= 0; i--) {
+        uint64_t features = 0;
+        for (int f = 0; f < Target::FeatureEnd; f++) {
+            if (targets[i].has_feature((Target::Feature)f) &&
+                !target.has_feature((Target::Feature)f)) {
+                features |= ((uint64_t)1) << f;
+            }
+        }
+        Expr can_use = Call::make(Int(32), "halide_can_use_target_features",
+                                  {make_const(UInt(64), features)}, Call::Extern);
+        choice = select(can_use != 0, i, choice);
+    }
+    Value *chosen = codegen(choice);
+    StoreInst *store = builder->CreateStore(chosen, chosen_version);
+    store->setAtomic(AtomicOrdering::Monotonic);
+    store->setAlignment(4);
+    choose_bb = builder->GetInsertBlock();
+    builder->CreateBr(dispatch_bb);
+
+    builder->SetInsertPoint(dispatch_bb);
+    PHINode *version = builder->CreatePHI(i32_t, 2);
+    version->addIncoming(cached, cached_bb);
+    version->addIncoming(chosen, choose_bb);
+    BasicBlock *base_bb = BasicBlock::Create(*context, "base version of " + op->name, function);
+    BasicBlock *after_bb = BasicBlock::Create(*context, "end dispatch " + op->name, function);
+    SwitchInst *dispatch = builder->CreateSwitch(version, base_bb, (unsigned)versions.size());
+
+    for (size_t i = 0; i < versions.size(); i++) {
+        BasicBlock *call_bb = BasicBlock::Create(*context, "call " + versions[i]->getName(), function);
+        dispatch->addCase(builder->getInt32(i), call_bb);
+        builder->SetInsertPoint(call_bb);
+        pack_closure(closure_t, closure_ptr, closure, symbol_table, buffer_t_type, builder);
+        Value *args[] = {user_context, builder->CreatePointerCast(closure_ptr, voidPointerType)};
+        Value *result = builder->CreateCall(versions[i], args);
+        Value *did_succeed = builder->CreateICmpEQ(result, ConstantInt::get(i32_t, 0));
+        create_assertion(did_succeed, Expr(), result);
+        builder->CreateBr(after_bb);
+    }
+
+    // The base version is compiled inline.
+    builder->SetInsertPoint(base_bb);
+    in_cpu_dispatch_loop = true;
+    op->accept(this);
+    in_cpu_dispatch_loop = false;
+    builder->CreateBr(after_bb);
+
+    builder->SetInsertPoint(after_bb);
+}
+
 void CodeGen_LLVM::visit(const For *op) {
+    // Dispatch on the outermost loops that contain vector code, so
+    // that the version is picked and the closure packed once per
+    // call to the pipeline, rather than every time an inner loop
+    // starts.
+    if ((op->for_type == ForType::Serial || op->for_type == ForType::Parallel) &&
+        !in_cpu_dispatch_loop && target.has_feature(Target::CPUDispatch)) {
+        vector<Target> targets = cpu_dispatch_targets();
+        if (!targets.empty()) {
+            IsCPUDispatchCandidate candidate;
+            op->body.accept(&candidate);
+            if (candidate.has_vectors) {
+                codegen_cpu_dispatch(op, targets);
+                return;
+            }
+        }
+    }
+
     Value *min = codegen(op->min);
     Value *extent = codegen(op->extent);
 
@@ -3095,6 +3339,11 @@ void CodeGen_LLVM::visit(const For *op) {
         function->addParamAttr(2, Attribute::NoAlias);
         #endif
         set_function_attributes_for_target(function, target);
+        // Tasks of a parallel loop inside a dispatched loop nest are
+        // compiled for the same target as the rest of the nest.
+        if (in_cpu_dispatch_loop) {
+            set_cpu_dispatch_attributes(function);
+        }
 
         // Make the initial basic block and jump the builder into the new function
         IRBuilderBase::InsertPoint call_site = builder->saveIP();
@@ -3134,8 +3383,17 @@ void CodeGen_LLVM::visit(const For *op) {
         unpack_closure(closure, symbol_table, closure_t, closure_handle, builder);
 
         // Generate the new function body
+        bool parent_nontemporal_stores_emitted = nontemporal_stores_emitted;
+        nontemporal_stores_emitted = false;
         codegen(op->body);
 
+        // Make any non-temporal stores in the task visible to the
+        // thread that waits for it to complete.
+        if (nontemporal_stores_emitted) {
+            builder->CreateFence(AtomicOrdering::SequentiallyConsistent);
+        }
+        nontemporal_stores_emitted = parent_nontemporal_stores_emitted;
+
         // Return success
         return_with_error_code(ConstantInt::get(i32_t, 0));
 
@@ -3229,6 +3487,12 @@ void CodeGen_LLVM::visit(const Store *op) {
             int store_lanes = value_type.lanes();
             int native_lanes = native_bits / value_type.bits();
 
+            // Streaming stores to an output that the schedule marks as
+            // write-once bypass the cache.
+            bool nontemporal = (is_external && op->param.defined() &&
+                                op->param.nontemporal_stores() &&
+                                (target.arch == Target::X86 || target.arch == Target::ARM));
+
             for (int i = 0; i < store_lanes; i += native_lanes) {
                 int slice_lanes = std::min(native_lanes, store_lanes - i);
                 Expr slice_base = simplify(ramp->base + i);
@@ -3239,6 +3503,11 @@ void CodeGen_LLVM::visit(const Store *op) {
                 Value *vec_ptr = builder->CreatePointerCast(elt_ptr, slice_val->getType()->getPointerTo());
                 StoreInst *store = builder->CreateAlignedStore(slice_val, vec_ptr, alignment);
                 add_tbaa_metadata(store, op->name, slice_index);
+                if (nontemporal && slice_lanes == native_lanes) {
+                    llvm::Metadata *one = ConstantAsMetadata::get(ConstantInt::get(i32_t, 1));
+                    store->setMetadata(LLVMContext::MD_nontemporal, MDNode::get(*context, one));
+                    nontemporal_stores_emitted = true;
+                }
             }
         } else if (ramp) {
             Type ptr_type = value_type.element_of();
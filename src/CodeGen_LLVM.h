@@ -107,6 +107,23 @@ protected:
     /** What's the natural vector bit-width to use for loads, stores, etc. */
     virtual int native_vector_bits() const = 0;
 
+    /** How many values may be carried across loop iterations in
+     * registers instead of being reloaded (see loop_carry). This
+     * should leave enough of the register file for the rest of the
+     * loop body. Zero disables the optimization. */
+    virtual int max_loop_carried_values() const {return 0;}
+
+    /** Which targets should loop nests containing vector code also be
+     * compiled for, when the target has the CPUDispatch feature? They
+     * should be listed from most to least preferred. The first one
+     * that the host supports is picked the first time such a loop
+     * runs, falling back to the version compiled for the target
+     * itself. The whole outermost loop containing vector code is
+     * compiled once per target, including any scalar code and
+     * parallel tasks inside it, so the code for that loop nest grows
+     * by a factor of one plus the number of targets. */
+    virtual std::vector<Target> cpu_dispatch_targets() const {return {};}
+
     /** State needed by llvm for code generation, including the
      * current module, function, context, builder, and most recently
      * generated llvm value. */
@@ -458,6 +475,15 @@ private:
      * to this block. */
     llvm::BasicBlock *destructor_block;
 
+    /** Whether non-temporal stores have been emitted into the current
+     * function. These are weakly ordered, so the function must end
+     * with a fence. */
+    bool nontemporal_stores_emitted;
+
+    /** Whether we are generating code inside a loop nest that is
+     * compiled once per cpu_dispatch_targets() target. */
+    bool in_cpu_dispatch_loop;
+
     /** Embed an instance of halide_filter_metadata_t in the code, using
      * the given name (by convention, this should be ${FUNCTIONNAME}_metadata)
      * as extern "C" linkage. Note that the return value is a function-returning-
@@ -474,6 +500,15 @@ private:
 
     llvm::Value *codegen_dense_vector_load(const Load *load, llvm::Value *vpred = nullptr);
 
+    /** Emit a loop once for each of the given targets, as separate
+     * functions, and branch to the best one the host supports. */
+    void codegen_cpu_dispatch(const For *op, const std::vector<Target> &targets);
+
+    /** Mark a function that is being generated inside a loop emitted
+     * by codegen_cpu_dispatch as compiled for the current target,
+     * rather than for the target of the module. */
+    void set_cpu_dispatch_attributes(llvm::Function *fn);
+
     virtual void codegen_predicated_vector_load(const Load *op);
     virtual void codegen_predicated_vector_store(const Store *op);
 };
@@ -60,10 +60,122 @@ bool should_use_pmaddwd(Expr a, Expr b, vector<Expr> &result) {
     return true;
 }
 
+// Flatten a tree of Adds into a list of terms.
+void collect_add_terms(const Expr &e, vector<Expr> &terms) {
+    if (const Add *add = e.as<Add>()) {
+        collect_add_terms(add->a, terms);
+        collect_add_terms(add->b, terms);
+    } else {
+        terms.push_back(e);
+    }
+}
+
+// Check if e is a widening multiply of something that fits in 'ta' by
+// something that fits in 'tb' (in either order).
+bool is_widening_mul(Expr e, Type ta, Type tb, Expr &a, Expr &b) {
+    const Mul *mul = e.as<Mul>();
+    if (!mul) {
+        return false;
+    }
+    ta = ta.with_lanes(e.type().lanes());
+    tb = tb.with_lanes(e.type().lanes());
+    for (int swap = 0; swap < 2; swap++) {
+        a = lossless_cast(ta, swap ? mul->b : mul->a);
+        b = lossless_cast(tb, swap ? mul->a : mul->b);
+        if (a.defined() && b.defined()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The AVX512-VNNI instructions vpdpbusd and vpdpwssd compute, for
+// each 32-bit lane, acc + a_0*b_0 + ... + a_{k-1}*b_{k-1}, where a_j
+// and b_j are the k narrow elements packed into that lane. A sum of
+// widening multiplies can use them by interleaving the narrow
+// operands. We recognize sums with at least k such multiplies here,
+// and return the narrow operands in groups of k along with the sum of
+// the remaining terms (if any).
+bool should_use_dot_product(const Add *op, Type ta, Type tb, int k,
+                            vector<Expr> &as, vector<Expr> &bs, Expr &rest) {
+    Type t = op->type;
+    if (!(t.is_int() && t.bits() == 32 && t.lanes() >= 4)) {
+        return false;
+    }
+
+    vector<Expr> terms;
+    collect_add_terms(op, terms);
+
+    vector<Expr> products;
+    for (const Expr &e : terms) {
+        Expr a, b;
+        if (is_widening_mul(e, ta, tb, a, b)) {
+            as.push_back(a);
+            bs.push_back(b);
+            products.push_back(e);
+        } else {
+            rest = rest.defined() ? rest + e : e;
+        }
+    }
+
+    // Products that don't fill a whole group are left to the accumulator.
+    while (as.size() % k) {
+        rest = rest.defined() ? rest + products.back() : products.back();
+        as.pop_back();
+        bs.pop_back();
+        products.pop_back();
+    }
+
+    return !as.empty();
+}
+
 }
 
 
 void CodeGen_X86::visit(const Add *op) {
+#if LLVM_VERSION >= 70
+    if (target.has_feature(Target::AVX512_VNNI)) {
+        struct DotProduct {
+            Type a, b;
+            int k;
+            string intrin;
+        };
+        static const DotProduct dot_products[] = {
+            {UInt(8), Int(8), 4, "vpdpbusd"},
+            {Int(16), Int(16), 2, "vpdpwssd"},
+        };
+        for (const DotProduct &d : dot_products) {
+            vector<Expr> as, bs;
+            Expr acc;
+            if (!should_use_dot_product(op, d.a, d.b, d.k, as, bs, acc)) {
+                continue;
+            }
+            // A single pair of 16-bit products with nothing to
+            // accumulate is better served by pmaddwd below.
+            if (d.k == 2 && as.size() == 2 && !acc.defined()) {
+                continue;
+            }
+
+            // Use the 512-bit instruction, or the AVX512-VL forms for
+            // narrower vectors.
+            int lanes = op->type.lanes();
+            int intrin_lanes = lanes >= 16 ? 16 : (lanes >= 8 ? 8 : 4);
+            string intrin = "llvm.x86.avx512." + d.intrin + "." + std::to_string(intrin_lanes * 32);
+            llvm::Type *result_type = llvm_type_of(op->type);
+
+            value = codegen(acc.defined() ? acc : make_zero(op->type));
+            for (size_t i = 0; i < as.size(); i += d.k) {
+                vector<Expr> group_a(as.begin() + i, as.begin() + i + d.k);
+                vector<Expr> group_b(bs.begin() + i, bs.begin() + i + d.k);
+                Value *a = builder->CreateBitCast(codegen(Shuffle::make_interleave(group_a)), result_type);
+                Value *b = builder->CreateBitCast(codegen(Shuffle::make_interleave(group_b)), result_type);
+                value = call_intrin(result_type, intrin_lanes, intrin, {value, a, b});
+            }
+            return;
+        }
+    }
+#endif
+
     vector<Expr> matches;
     if (should_use_pmaddwd(op->a, op->b, matches)) {
         codegen(Call::make(op->type, "pmaddwd", matches, Call::Extern));
@@ -384,6 +496,11 @@ string CodeGen_X86::mattrs() const {
         if (target.has_feature(Target::AVX512_Cannonlake)) {
             features += ",+avx512ifma,+avx512vbmi";
         }
+#if LLVM_VERSION >= 70
+        if (target.has_feature(Target::AVX512_VNNI)) {
+            features += ",+avx512vnni";
+        }
+#endif
     }
     return features;
 }
@@ -406,4 +523,46 @@ int CodeGen_X86::native_vector_bits() const {
     }
 }
 
+int CodeGen_X86::max_loop_carried_values() const {
+    // Depending on the cache and the number of load ports, reloading
+    // can be cheaper, so this is opt-in.
+    if (!target.has_feature(Target::LoopCarry)) {
+        return 0;
+    }
+    // Use at most half of the vector registers for carrying values:
+    // AVX-512 has 32 of them, earlier versions have 16.
+    if (native_vector_bits() == 512) {
+        return 16;
+    } else {
+        return 8;
+    }
+}
+
+std::vector<Target> CodeGen_X86::cpu_dispatch_targets() const {
+    // Each of these is only worth compiling for if the target doesn't
+    // already have it, or something better.
+    std::vector<Target> targets;
+    if (target.has_feature(Target::AVX512_Skylake) ||
+        target.has_feature(Target::AVX512_Cannonlake)) {
+        return targets;
+    }
+    Target avx2 = target;
+    avx2.set_features({Target::SSE41, Target::AVX, Target::AVX2, Target::FMA, Target::F16C});
+    Target avx512 = avx2;
+    avx512.set_features({Target::AVX512, Target::AVX512_Skylake});
+    targets.push_back(avx512);
+
+    if (target.has_feature(Target::AVX2)) {
+        return targets;
+    }
+    targets.push_back(avx2);
+
+    if (target.has_feature(Target::SSE41) ||
+        target.has_feature(Target::AVX)) {
+        return targets;
+    }
+    targets.push_back(target.with_feature(Target::SSE41));
+    return targets;
+}
+
 }}
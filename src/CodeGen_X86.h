@@ -28,6 +28,8 @@ protected:
     std::string mattrs() const;
     bool use_soft_float_abi() const;
     int native_vector_bits() const;
+    int max_loop_carried_values() const;
+    std::vector<Target> cpu_dispatch_targets() const;
 
     Expr mulhi_shr(Expr a, Expr b, int shr);
 
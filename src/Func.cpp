@@ -31,6 +31,7 @@
 #include "Associativity.h"
 #include "ApplySplit.h"
 #include "ImageParam.h"
+#include "ParallelRVar.h"
 
 namespace Halide {
 
@@ -1453,8 +1454,21 @@ Stage &Stage::tile(VarOrRVar x, VarOrRVar y,
 }
 
 namespace {
+// Find the reduction variable that a loop dimension is, or was split
+// or fused from.
+string base_rvar(const string &dim, const vector<ReductionVariable> &rvars) {
+    for (const auto &rv : rvars) {
+        if (dim == rv.var || starts_with(dim, rv.var + ".")) {
+            return rv.var;
+        }
+    }
+    return dim;
+}
+
 // An helper function for reordering vars in a schedule.
-void reorder_vars(vector<Dim> &dims_old, const VarOrRVar *vars, size_t size, const Stage &stage) {
+void reorder_vars(Definition &def, const string &func_name,
+                  const VarOrRVar *vars, size_t size, const Stage &stage) {
+    vector<Dim> &dims_old = def.schedule().dims();
     vector<Dim> dims = dims_old;
 
     // Tag all the vars with their locations in the dims list.
@@ -1474,13 +1488,25 @@ void reorder_vars(vector<Dim> &dims_old, const VarOrRVar *vars, size_t size, con
             << stage.dump_argument_list();
     }
 
-    // Look for illegal reorderings
+    // Look for illegal reorderings. Loops over RVars may only be
+    // interchanged if it provably doesn't change the result.
+    int permutable = -1;
+    bool any_order = false;
     for (size_t i = 0; i < idx.size(); i++) {
         if (dims[idx[i]].is_pure()) continue;
         for (size_t j = i+1; j < idx.size(); j++) {
             if (dims[idx[j]].is_pure()) continue;
 
             if (idx[i] > idx[j]) {
+                if (permutable < 0) {
+                    permutable = can_permute_rvars(func_name, def, &any_order);
+                }
+                const vector<ReductionVariable> &rvars = def.schedule().rvars();
+                if (any_order ||
+                    (permutable &&
+                     base_rvar(dims[idx[i]].var, rvars) != base_rvar(dims[idx[j]].var, rvars))) {
+                    continue;
+                }
                 user_error
                     << "In schedule for " << stage.name()
                     << ", can't reorder RVars " << vars[i].name()
@@ -1503,7 +1529,8 @@ void reorder_vars(vector<Dim> &dims_old, const VarOrRVar *vars, size_t size, con
 }
 
 Stage &Stage::reorder(const std::vector<VarOrRVar>& vars) {
-    reorder_vars(definition.schedule().dims(), &vars[0], vars.size(), *this);
+    const string func_name = split_string(stage_name, ".update(")[0];
+    reorder_vars(definition, func_name, &vars[0], vars.size(), *this);
     return *this;
 }
 
@@ -2350,6 +2377,21 @@ Func &Func::align_storage(Var dim, Expr alignment) {
     return *this;
 }
 
+Func &Func::pad_storage(Var dim) {
+    invalidate_cache();
+
+    vector<StorageDim> &dims = func.schedule().storage_dims();
+    for (size_t i = 0; i < dims.size(); i++) {
+        if (var_name_match(dims[i].var, dim.name())) {
+            dims[i].pad_critical_stride = true;
+            return *this;
+        }
+    }
+    user_error << "Could not find variable " << dim.name()
+               << " to pad the storage of.\n";
+    return *this;
+}
+
 Func &Func::fold_storage(Var dim, Expr factor, bool fold_forward) {
     invalidate_cache();
 
@@ -2366,6 +2408,14 @@ Func &Func::fold_storage(Var dim, Expr factor, bool fold_forward) {
     return *this;
 }
 
+Func &Func::store_nontemporal() {
+    invalidate_cache();
+    for (Parameter p : func.output_buffers()) {
+        p.set_nontemporal_stores(true);
+    }
+    return *this;
+}
+
 Func &Func::compute_at(LoopLevel loop_level) {
     invalidate_cache();
     func.schedule().compute_level() = loop_level;
@@ -193,6 +193,16 @@ public:
                        VarOrRVar xi, VarOrRVar yi,
                        Expr xfactor, Expr yfactor,
                        TailStrategy tail = TailStrategy::Auto);
+
+    /** Reorder variables to have the given nesting order, from
+     * innermost out. Loops over RVars may only be interchanged (and
+     * hence tiled) when Halide can prove it doesn't change the
+     * result: either the update is a commutative and associative
+     * reduction such as a sum, or every RVar indexes its own
+     * dimension of the Func and no iteration of the reduction domain
+     * depends on one that is later along some RVar and earlier along
+     * another. In the latter case, the pieces of a split RVar must
+     * stay in order. */
     EXPORT Stage &reorder(const std::vector<VarOrRVar> &vars);
 
     template <typename... Args>
@@ -1719,6 +1729,20 @@ public:
      * aligned to multiples of 16, use foo.align_storage(x, 16). */
     EXPORT Func &align_storage(Var dim, Expr alignment);
 
+    /** Pad the storage extent of a particular dimension of
+     * realizations of this function by a cache line whenever the
+     * stride of the next dimension out would otherwise be a multiple
+     * of 1024 bytes. With such a critical stride, the elements of a
+     * column all map to a handful of cache sets, and loads and stores
+     * a multiple of 4096 bytes apart falsely depend on each other,
+     * which slows down tiled and transposed access to intermediates
+     * with power-of-two extents. Usually dim is the innermost
+     * storage dimension. The padding is chosen at runtime from the
+     * actual extent, so this is free when the stride isn't critical.
+     * Any align_storage directive on the same dimension is still
+     * respected. */
+    EXPORT Func &pad_storage(Var dim);
+
     /** Store realizations of this function in a circular buffer of a
      * given extent. This is more efficient when the extent of the
      * circular buffer is a power of 2. If the fold factor is too
@@ -1751,6 +1775,17 @@ public:
      */
     EXPORT Func &fold_storage(Var dim, Expr extent, bool fold_forward = true);
 
+    /** Write the output of this Func with non-temporal (streaming)
+     * vector stores on x86 and ARM, which bypass the cache. This is a
+     * win for large outputs which are written once and not read again
+     * by the pipeline, as the stores no longer evict the inputs and
+     * intermediates from the last level cache. A fence is inserted at
+     * the end of each parallel task and of the pipeline, so that the
+     * output is visible once the pipeline returns. Dense vector stores
+     * of a full native vector are made non-temporal; other stores are
+     * unaffected. Only applies to Funcs that are pipeline outputs. */
+    EXPORT Func &store_nontemporal();
+
     /** Compute this function as needed for each unique value of the
      * given var for the given calling function f.
      *
@@ -701,11 +701,74 @@ const std::map<std::string, LoopLevel> &get_halide_looplevel_enum_map() {
     return halide_looplevel_enum_map;
 }
 
+namespace {
+
+// Emit a header-only wrapper around Halide::Runtime::PipelineInstance
+// (see HalidePipelineInstance.h) that calls the given pipeline, which
+// must take a __user_context, with the instance as its user_context.
+void emit_pipeline_instance(const std::string &file_path,
+                            const std::string &header_name,
+                            const std::string &function_name,
+                            const std::vector<LoweredArgument> &args) {
+    std::vector<std::string> namespaces;
+    std::string name = extract_namespaces(function_name, namespaces);
+
+    std::ofstream file(file_path);
+    file << "#ifndef HALIDE_" << name << "_INSTANCE_H\n"
+         << "#define HALIDE_" << name << "_INSTANCE_H\n\n"
+         << "#include \"HalidePipelineInstance.h\"\n"
+         << "#include \"" << header_name << "\"\n\n";
+    for (const auto &ns : namespaces) {
+        file << "namespace " << ns << " {\n";
+    }
+    if (!namespaces.empty()) {
+        file << "\n";
+    }
+
+    std::string params, call_args;
+    for (const auto &arg : args) {
+        if (arg.name == "__user_context") {
+            continue;
+        }
+        params += ",\n    ";
+        if (arg.is_buffer()) {
+            params += "struct halide_buffer_t *" + arg.name;
+        } else {
+            params += halide_type_to_c_type(arg.type) + " " + arg.name;
+        }
+        call_args += ", " + arg.name;
+    }
+
+    file << "typedef Halide::Runtime::PipelineInstance " << name << "_instance_t;\n\n"
+         << "inline " << name << "_instance_t *" << name << "_instance_create() {\n"
+         << "    return new " << name << "_instance_t;\n"
+         << "}\n\n"
+         << "inline int " << name << "_instance_run(\n"
+         << "    " << name << "_instance_t *instance" << params << ") {\n"
+         << "    return instance->run([&](void *user_context) {\n"
+         << "        return " << name << "(user_context" << call_args << ");\n"
+         << "    });\n"
+         << "}\n\n"
+         << "inline void " << name << "_instance_destroy(" << name << "_instance_t *instance) {\n"
+         << "    delete instance;\n"
+         << "}\n";
+
+    if (!namespaces.empty()) {
+        file << "\n";
+    }
+    for (size_t i = namespaces.size(); i > 0; i--) {
+        file << "}  // namespace " << namespaces[i-1] << "\n";
+    }
+    file << "\n#endif  // HALIDE_" << name << "_INSTANCE_H\n";
+}
+
+}  // namespace
+
 int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
     const char kUsage[] = "gengen [-g GENERATOR_NAME] [-f FUNCTION_NAME] [-o OUTPUT_DIR] [-r RUNTIME_NAME] [-e EMIT_OPTIONS] [-x EXTENSION_OPTIONS] [-n FILE_BASE_NAME] "
                           "target=target-string[,target-string...] [generator_arg=value [...]]\n\n"
                           "  -e  A comma separated list of files to emit. Accepted values are "
-                          "[assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub, schedule]. If omitted, default value is [static_library, h].\n"
+                          "[assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub, schedule, instance]. If omitted, default value is [static_library, h].\n"
                           "  -x  A comma separated list of file extension pairs to substitute during file naming, "
                           "in the form [.old=.new[,.old2=.new2]]\n";
 
@@ -822,9 +885,11 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                 emit_options.emit_cpp_stub = true;
             } else if (opt == "schedule") {
                 emit_options.emit_schedule = true;
+            } else if (opt == "instance") {
+                emit_options.emit_instance = true;
             } else if (!opt.empty()) {
                 cerr << "Unrecognized emit option: " << opt
-                     << " not one of [assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub], ignoring.\n";
+                     << " not one of [assembly, bitcode, cpp, h, html, o, static_library, stmt, cpp_stub, schedule, instance], ignoring.\n";
             }
         }
     }
@@ -872,15 +937,36 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
 
         // Don't bother with this if we're just emitting a cpp_stub.
         if (!stub_only) {
+            if (emit_options.emit_instance) {
+                for (const auto &t : targets) {
+                    if (!t.has_feature(Target::UserContext)) {
+                        cerr << "Emitting an instance requires the user_context target feature\n";
+                        return 1;
+                    }
+                }
+            }
             Outputs output_files = compute_outputs(targets[0], base_path, emit_options);
-            auto module_producer = [&generator_name, &generator_args]
+            // All the targets produce a function with the same signature;
+            // the instance wrapper just needs one of them.
+            std::vector<LoweredArgument> instance_args;
+            bool have_instance_args = false;
+            auto module_producer = [&generator_name, &generator_args, &instance_args, &have_instance_args]
                 (const std::string &name, const Target &target) -> Module {
                     auto sub_generator_args = generator_args;
                     sub_generator_args.erase("target");
                     // Must re-create each time since each instance will have a different Target.
                     auto gen = GeneratorRegistry::create(generator_name, GeneratorContext(target));
                     gen->set_generator_and_schedule_param_values(sub_generator_args);
-                    return gen->build_module(name);
+                    Module m = gen->build_module(name);
+                    if (!have_instance_args) {
+                        for (const auto &f : m.functions()) {
+                            if (f.name == name) {
+                                instance_args = f.args;
+                                have_instance_args = true;
+                            }
+                        }
+                    }
+                    return m;
                 };
             if (targets.size() > 1 || !emit_options.substitutions.empty()) {
                 compile_multitarget(function_name, output_files, targets, module_producer, emit_options.substitutions);
@@ -890,6 +976,13 @@ int generate_filter_main(int argc, char **argv, std::ostream &cerr) {
                 // so defer directly to Module::compile if there is a single target.
                 module_producer(function_name, targets[0]).compile(output_files);
             }
+            if (emit_options.emit_instance) {
+                internal_assert(have_instance_args);
+                std::string header_path = base_path + get_extension(".h", emit_options);
+                std::string header_name = header_path.substr(header_path.find_last_of('/') + 1);
+                emit_pipeline_instance(base_path + get_extension(".instance.h", emit_options),
+                                       header_name, function_name, instance_args);
+            }
         }
     }
 
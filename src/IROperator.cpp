@@ -2,6 +2,7 @@
 #include <sstream>
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 #include "IROperator.h"
 #include "IRPrinter.h"
@@ -14,28 +15,30 @@ namespace Halide {
 
 // Evaluate a float polynomial efficiently, taking instruction latency
 // into account. The high order terms come first. n is the number of
-// terms, which is the degree plus one.
+// terms, which is the degree plus one. The coefficients are floats for
+// Float(32) polynomials and doubles for Float(64) polynomials.
 namespace {
-Expr evaluate_polynomial(const Expr &x, float *coeff, int n) {
+template<typename T>
+Expr evaluate_polynomial(const Expr &x, const T *coeff, int n) {
     internal_assert(n >= 2);
 
     Expr x2 = x * x;
 
-    Expr even_terms = coeff[0];
-    Expr odd_terms = coeff[1];
+    Expr even_terms = Expr(coeff[0]);
+    Expr odd_terms = Expr(coeff[1]);
 
     for (int i = 2; i < n; i++) {
         if ((i & 1) == 0) {
-            if (coeff[i] == 0.0f) {
+            if (coeff[i] == 0) {
                 even_terms *= x2;
             } else {
-                even_terms = even_terms * x2 + coeff[i];
+                even_terms = even_terms * x2 + Expr(coeff[i]);
             }
         } else {
-            if (coeff[i] == 0.0f) {
+            if (coeff[i] == 0) {
                 odd_terms *= x2;
             } else {
-                odd_terms = odd_terms * x2 + coeff[i];
+                odd_terms = odd_terms * x2 + Expr(coeff[i]);
             }
         }
     }
@@ -492,8 +495,214 @@ void range_reduce_log(const Expr &input, Expr *reduced, Expr *exponent) {
     *reduced = reinterpret(type, blended);
 }
 
+namespace {
+
+// Double precision versions of the transcendentals, based on the ones
+// in Cephes (http://www.netlib.org/cephes/). They are accurate to about
+// one ulp.
+
+Expr halide_log_f64(const Expr &x_full) {
+    Type type = x_full.type();
+    Type int_type = Int(64, type.lanes());
+
+    Expr nan = Call::make(type, "nan_f64", {}, Call::PureExtern);
+    Expr inf = Call::make(type, "inf_f64", {}, Call::PureExtern);
+    Expr neg_inf = Call::make(type, "neg_inf_f64", {}, Call::PureExtern);
+
+    Expr use_nan = x_full < Expr(0.0) ||
+        Call::make(Bool(type.lanes()), "is_nan_f64", {x_full}, Call::PureExtern);
+    Expr use_neg_inf = x_full == Expr(0.0);
+    Expr use_inf = x_full == inf;
+    Expr exceptional = use_nan | use_neg_inf | use_inf;
+    Expr patched = select(exceptional, make_one(type), x_full);
+
+    // Scale denormals up into the normal range.
+    Expr denormal = patched < Expr(std::numeric_limits<double>::min());
+    patched = select(denormal, patched * Expr(18014398509481984.0), patched);
+
+    // Split into a mantissa in [0.5, 1) and an exponent.
+    Expr bits = reinterpret(int_type, patched);
+    Expr exponent = cast(type, ((bits >> 52) & make_const(int_type, 0x7ff)) - 1022);
+    exponent = select(denormal, exponent - Expr(54.0), exponent);
+    Expr mantissa = reinterpret(type, (bits & make_const(int_type, (int64_t)0x800fffffffffffffLL)) |
+                                      make_const(int_type, (int64_t)0x3fe0000000000000LL));
+
+    // Move the mantissa into [sqrt(0.5), sqrt(2)), and subtract one.
+    Expr small = mantissa < Expr(0.70710678118654752440);
+    exponent = select(small, exponent - Expr(1.0), exponent);
+    Expr x = select(small, mantissa + mantissa, mantissa) - Expr(1.0);
+
+    // log(1 + x) = x - x^2/2 + x^3 * P(x)/Q(x)
+    double p[] = {
+        1.01875663804580931796E-4,
+        4.97494994976747001425E-1,
+        4.70579119878881725854E0,
+        1.44989225341610930846E1,
+        1.79368678507819816313E1,
+        7.70838733755885391666E0};
+    double q[] = {
+        1.0,
+        1.12873587189167450590E1,
+        4.52279145837532221105E1,
+        8.29875266912776603211E1,
+        7.11544750618563894466E1,
+        2.31251620126765340583E1};
+    Expr z = x * x;
+    Expr y = x * (z * evaluate_polynomial(x, p, 6) / evaluate_polynomial(x, q, 6));
+
+    // Add on exponent * log(2), with log(2) split into two parts so that
+    // the larger part can be multiplied exactly.
+    y -= exponent * Expr(2.121944400546905827679e-4);
+    y -= Expr(0.5) * z;
+    Expr result = (x + y) + exponent * Expr(0.693359375);
+
+    result = select(exceptional, select(use_nan, nan, select(use_inf, inf, neg_inf)), result);
+
+    return common_subexpression_elimination(result);
+}
+
+Expr halide_exp_f64(const Expr &x_full) {
+    Type type = x_full.type();
+    Type int_type = Int(64, type.lanes());
+
+    // Beyond this range the result overflows to infinity or underflows
+    // to zero anyway.
+    Expr x = clamp(x_full, Expr(-746.0), Expr(710.0));
+
+    // exp(x) = 2^k * exp(r), where r is in [-log(2)/2, log(2)/2].
+    Expr k_real = floor(x * Expr(1.4426950408889634073599) + Expr(0.5));
+    x -= k_real * Expr(6.93145751953125E-1);
+    x -= k_real * Expr(1.42860682030941723212E-6);
+
+    // exp(r) = 1 + 2 * r * P(r^2) / (Q(r^2) - r * P(r^2))
+    double p[] = {
+        1.26177193074810590878E-4,
+        3.02994407707441961300E-2,
+        9.99999999999999999910E-1};
+    double q[] = {
+        3.00198505138664455042E-6,
+        2.52448340349684104192E-3,
+        2.27265548208155028766E-1,
+        2.00000000000000000009E0};
+    Expr xx = x * x;
+    Expr px = x * evaluate_polynomial(xx, p, 3);
+    Expr result = px / (evaluate_polynomial(xx, q, 4) - px);
+    result = Expr(1.0) + Expr(2.0) * result;
+
+    // Multiply by 2^k in two steps, so that results that are
+    // denormal or close to overflowing come out right.
+    Expr k = cast(int_type, k_real);
+    Expr k1 = k >> 1;
+    Expr k2 = k - k1;
+    result *= reinterpret(type, (k1 + 1023) << 52);
+    result *= reinterpret(type, (k2 + 1023) << 52);
+
+    // The clamp above turns NaNs into numbers.
+    Expr is_nan = Call::make(Bool(type.lanes()), "is_nan_f64", {x_full}, Call::PureExtern);
+    result = select(is_nan, x_full, result);
+
+    return common_subexpression_elimination(result);
+}
+
+// Sine and cosine in single or double precision, based on sinf/cosf and
+// sin/cos from Cephes. The argument is reduced to [-pi/4, pi/4] by
+// subtracting a multiple of pi/4 in three parts, which is only accurate
+// up to halide_sin_cos_max_argument. Beyond that, and for infinities and
+// NaNs, the result is NaN.
+Expr halide_sin_cos(const Expr &x_full, bool is_cos) {
+    Type type = x_full.type();
+    Type int_type = Int(32, type.lanes());
+    bool is_f64 = type.element_of() == Float(64);
+    internal_assert(is_f64 || type.element_of() == Float(32));
+
+    auto c = [&](double v) { return make_const(type, v); };
+
+    // Substitute a zero for arguments we can't reduce, so that the
+    // octant below fits in an int.
+    Expr in_range = abs(x_full) <= c(halide_sin_cos_max_argument(type));
+
+    // Find the octant, rounding odd octants up to the next even one.
+    Expr x = select(in_range, abs(x_full), c(0.0));
+    Expr y = floor(x * c(1.27323954473516268615));
+    Expr j = cast(int_type, y - floor(y * c(0.125)) * c(8.0));
+    Expr odd = (j & make_const(int_type, 1)) == 1;
+    y = select(odd, y + c(1.0), y);
+    j = select(odd, j + 1, j) & make_const(int_type, 7);
+
+    // Use the symmetries of sin and cos to map octants 4 to 7 onto 0
+    // to 3.
+    Expr upper = j > 3;
+    j = select(upper, j - 4, j);
+    Expr negate;
+    if (is_cos) {
+        negate = select(upper, j <= 1, j > 1);
+    } else {
+        negate = select(upper, x_full >= c(0.0), x_full < c(0.0));
+    }
+
+    if (is_f64) {
+        x = ((x - y * c(7.85398125648498535156E-1)) -
+             y * c(3.77489470793079817668E-8)) -
+            y * c(2.69515142907905952645E-15);
+    } else {
+        x = ((x - y * c(0.78515625)) - y * c(2.4187564849853515625e-4)) -
+            y * c(3.77489497744594108e-8);
+    }
+    Expr z = x * x;
+
+    Expr sin_poly, cos_poly;
+    if (is_f64) {
+        double s[] = {
+            1.58962301576546568060E-10,
+            -2.50507477628578072866E-8,
+            2.75573136213857245213E-6,
+            -1.98412698295895385996E-4,
+            8.33333333332211858878E-3,
+            -1.66666666666666307295E-1};
+        double k[] = {
+            -1.13585365213876817300E-11,
+            2.08757008419747316778E-9,
+            -2.75573141792967388112E-7,
+            2.48015872888517045348E-5,
+            -1.38888888888730564116E-3,
+            4.16666666666665929218E-2};
+        sin_poly = evaluate_polynomial(z, s, 6);
+        cos_poly = evaluate_polynomial(z, k, 6);
+    } else {
+        float s[] = {
+            -1.9515295891E-4f,
+            8.3321608736E-3f,
+            -1.6666654611E-1f};
+        float k[] = {
+            2.443315711809948E-005f,
+            -1.388731625493765E-003f,
+            4.166664568298827E-002f};
+        sin_poly = evaluate_polynomial(z, s, 3);
+        cos_poly = evaluate_polynomial(z, k, 3);
+    }
+    sin_poly = x + x * z * sin_poly;
+    cos_poly = c(1.0) - c(0.5) * z + z * z * cos_poly;
+
+    Expr use_cos = (j == 1) || (j == 2);
+    if (is_cos) {
+        use_cos = !use_cos;
+    }
+    Expr result = select(use_cos, cos_poly, sin_poly);
+    result = select(negate, -result, result);
+
+    Expr nan = Call::make(type, is_f64 ? "nan_f64" : "nan_f32", {}, Call::PureExtern);
+    result = select(in_range, result, nan);
+
+    return common_subexpression_elimination(result);
+}
+
+}  // namespace
+
 Expr halide_log(Expr x_full) {
     Type type = x_full.type();
+    if (type.element_of() == Float(64)) {
+        return halide_log_f64(x_full);
+    }
     internal_assert(type.element_of() == Float(32));
 
     Expr nan = Call::make(type, "nan_f32", {}, Call::PureExtern);
@@ -538,6 +747,9 @@ Expr halide_log(Expr x_full) {
 
 Expr halide_exp(Expr x_full) {
     Type type = x_full.type();
+    if (type.element_of() == Float(64)) {
+        return halide_exp_f64(x_full);
+    }
     internal_assert(type.element_of() == Float(32));
 
     float ln2_part1 = 0.6931457519f;
@@ -583,6 +795,24 @@ Expr halide_exp(Expr x_full) {
     return result;
 }
 
+double halide_sin_cos_max_argument(Type t) {
+    // Past these, the last part of pi/4 in the reduction doesn't have
+    // enough bits (these are the limits used by Cephes).
+    if (t.element_of() == Float(64)) {
+        return 1.073741824e9;
+    } else {
+        return 8192.0;
+    }
+}
+
+Expr halide_sin(Expr x) {
+    return halide_sin_cos(x, false);
+}
+
+Expr halide_cos(Expr x) {
+    return halide_sin_cos(x, true);
+}
+
 Expr halide_erf(Expr x_full) {
     user_assert(x_full.type() == Float(32)) << "halide_erf only works for Float(32)";
 
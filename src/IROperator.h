@@ -159,11 +159,18 @@ EXPORT Expr lossless_cast(Type t, Expr e);
  */
 EXPORT void match_types(Expr &a, Expr &b);
 
-/** Halide's vectorizable transcendentals. */
+/** Halide's vectorizable transcendentals. halide_log, halide_exp,
+ * halide_sin and halide_cos take Float(32) or Float(64) arguments, and
+ * are accurate to a few ulp. halide_sin and halide_cos return NaN for
+ * arguments larger in magnitude than halide_sin_cos_max_argument, as
+ * well as for infinities and NaNs. halide_erf only takes Float(32). */
 // @{
 EXPORT Expr halide_log(Expr a);
 EXPORT Expr halide_exp(Expr a);
+EXPORT Expr halide_sin(Expr a);
+EXPORT Expr halide_cos(Expr a);
 EXPORT Expr halide_erf(Expr a);
+EXPORT double halide_sin_cos_max_argument(Type t);
 // @}
 
 /** Raise an expression to an integer power by repeatedly multiplying
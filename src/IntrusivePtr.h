@@ -15,14 +15,27 @@
 namespace Halide {
 namespace Internal {
 
-/** A class representing a reference count to be used with IntrusivePtr */
+/** A class representing a reference count to be used with IntrusivePtr.
+ *
+ * The count is atomic even though most lowering is single-threaded,
+ * because IR is shared between threads (e.g. by the JIT and by
+ * generators run in parallel) and can outlive the lowering that made
+ * it, so there is no point at which a node is known to only be
+ * reachable from one thread. For the same reason IR nodes are not
+ * allocated from a per-lowering arena. */
 class RefCount {
     std::atomic<int> count;
 public:
     RefCount() : count(0) {}
-    int increment() {return ++count;} // Increment and return new value
-    int decrement() {return --count;} // Decrement and return new value
-    bool is_zero() const {return count == 0;}
+    // Increment and return new value. Taking a new reference requires
+    // already holding one, so this needs no ordering with respect to
+    // other memory operations.
+    int increment() {return count.fetch_add(1, std::memory_order_relaxed) + 1;}
+    // Decrement and return new value. The release makes prior writes
+    // to the object visible to whichever thread destroys it, and the
+    // acquire makes them visible to this one if it does.
+    int decrement() {return count.fetch_sub(1, std::memory_order_acq_rel) - 1;}
+    bool is_zero() const {return count.load(std::memory_order_acquire) == 0;}
 };
 
 /**
@@ -183,11 +183,13 @@ DECLARE_LL_INITMOD(ptx_compute_35)
 
 #ifdef WITH_X86
 DECLARE_LL_INITMOD(x86_avx)
+DECLARE_LL_INITMOD(x86_avx512)
 DECLARE_LL_INITMOD(x86)
 DECLARE_LL_INITMOD(x86_sse41)
 DECLARE_CPP_INITMOD(x86_cpu_features)
 #else
 DECLARE_NO_INITMOD(x86_avx)
+DECLARE_NO_INITMOD(x86_avx512)
 DECLARE_NO_INITMOD(x86)
 DECLARE_NO_INITMOD(x86_sse41)
 DECLARE_NO_INITMOD(x86_cpu_features)
@@ -791,17 +793,33 @@ std::unique_ptr<llvm::Module> get_initial_module_for_target(Target t, llvm::LLVM
             } else {
                 modules.push_back(get_initmod_prefetch(c, bits_64, debug));
             }
-            if (t.has_feature(Target::SSE41)) {
+            // Loops compiled for newer instruction sets by cpu_dispatch
+            // may use any of the x86 modules.
+            bool x86_dispatch = t.arch == Target::X86 && t.has_feature(Target::CPUDispatch);
+            if (t.has_feature(Target::SSE41) || x86_dispatch) {
                 modules.push_back(get_initmod_x86_sse41_ll(c));
             }
-            if (t.has_feature(Target::AVX)) {
+            if (t.has_feature(Target::AVX) || x86_dispatch) {
                 modules.push_back(get_initmod_x86_avx_ll(c));
             }
+            if (t.has_feature(Target::AVX512_Skylake) ||
+                t.has_feature(Target::AVX512_Cannonlake) ||
+                x86_dispatch) {
+                modules.push_back(get_initmod_x86_avx512_ll(c));
+            }
             if (t.has_feature(Target::Profile)) {
                 modules.push_back(get_initmod_profiler_inlined(c, bits_64, debug));
             }
         }
 
+        if (module_type == ModuleJITInlined &&
+            t.arch == Target::X86 && t.has_feature(Target::CPUDispatch)) {
+            // JIT-compiled pipelines that use cpu_dispatch query the
+            // host cpu features too.
+            modules.push_back(get_initmod_can_use_target(c, bits_64, debug));
+            modules.push_back(get_initmod_x86_cpu_features(c, bits_64, debug));
+        }
+
         if (module_type == ModuleAOT) {
             // These modules are only used for AOT compilation
             modules.push_back(get_initmod_can_use_target(c, bits_64, debug));
@@ -10,8 +10,10 @@ namespace Internal {
  * induction variables instead of redoing the load. If the loads are
  * predicated, the predicates need to match. Can be an optimization or
  * pessimization depending on how good the L1 cache is on the architecture
- * and how many memory issue slots there are. Currently only intended
- * for Hexagon. */
+ * and how many memory issue slots there are. Code generators opt in via
+ * CodeGen_LLVM::max_loop_carried_values, which also bounds
+ * max_carried_values by the size of the register file. Hexagon always
+ * does; x86 and ARM only with the loop_carry target feature. */
 Stmt loop_carry(Stmt, int max_carried_values = 8);
 
 }
@@ -5,6 +5,7 @@
 
 #include "Lower.h"
 
+#include "AccumulateInRegisters.h"
 #include "AddImageChecks.h"
 #include "AddParameterChecks.h"
 #include "AllocationBoundsInference.h"
@@ -74,7 +75,7 @@ using std::map;
 
 Module lower(const vector<Function> &output_funcs, const string &pipeline_name, const Target &t,
              const vector<Argument> &args, const Internal::LoweredFunc::LinkageType linkage_type,
-             const vector<IRMutator2 *> &custom_passes) {
+             const vector<IRMutator2 *> &custom_passes, bool skip_argument_checks) {
     std::vector<std::string> namespaces;
     std::string simple_pipeline_name = extract_namespaces(pipeline_name, namespaces);
 
@@ -135,9 +136,11 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     s = inject_tracing(s, pipeline_name, env, outputs, t);
     debug(2) << "Lowering after injecting tracing:\n" << s << '\n';
 
-    debug(1) << "Adding checks for parameters\n";
-    s = add_parameter_checks(s, t);
-    debug(2) << "Lowering after injecting parameter checks:\n" << s << '\n';
+    if (!skip_argument_checks) {
+        debug(1) << "Adding checks for parameters\n";
+        s = add_parameter_checks(s, t);
+        debug(2) << "Lowering after injecting parameter checks:\n" << s << '\n';
+    }
 
     // Compute the maximum and minimum possible value of each
     // function. Used in later bounds inference passes.
@@ -147,7 +150,7 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     // The checks will be in terms of the symbols defined by bounds
     // inference.
     debug(1) << "Adding checks for images\n";
-    s = add_image_checks(s, outputs, t, order, env, func_bounds);
+    s = add_image_checks(s, outputs, t, order, env, func_bounds, skip_argument_checks);
     debug(2) << "Lowering after injecting image checks:\n" << s << '\n';
 
     // This pass injects nested definitions of variable names, so we
@@ -280,6 +283,12 @@ Module lower(const vector<Function> &output_funcs, const string &pipeline_name,
     s = trim_no_ops(s);
     debug(2) << "Lowering after loop trimming:\n" << s << "\n\n";
 
+    if (t.has_feature(Target::AccumulateInRegisters)) {
+        debug(1) << "Holding reduction accumulators in registers...\n";
+        s = accumulate_in_registers(s);
+        debug(2) << "Lowering after holding reduction accumulators in registers:\n" << s << "\n\n";
+    }
+
     debug(1) << "Injecting early frees...\n";
     s = inject_early_frees(s);
     debug(2) << "Lowering after injecting early frees:\n" << s << "\n\n";
@@ -25,10 +25,15 @@ class IRMutator2;
  * contain submodules for computation offloaded to another execution
  * engine or API as well as buffers that are used in the passed in
  * Stmt. Multiple LoweredFuncs are added to support legacy buffer_t
- * calling convention. */
+ * calling convention. If skip_argument_checks is true, the arguments
+ * are trusted to be valid: the checks of the scalar and buffer
+ * arguments are left out, except for the host alignment of the
+ * buffers, and bounds queries are not supported. All other runtime
+ * checks are kept. */
 EXPORT Module lower(const std::vector<Function> &output_funcs, const std::string &pipeline_name, const Target &t,
                     const std::vector<Argument> &args, const Internal::LoweredFunc::LinkageType linkage_type,
-                    const std::vector<IRMutator2 *> &custom_passes = std::vector<IRMutator2 *>());
+                    const std::vector<IRMutator2 *> &custom_passes = std::vector<IRMutator2 *>(),
+                    bool skip_argument_checks = false);
 
 /** Given a halide function with a schedule, create a statement that
  * evaluates it. Automatically pulls in all the functions f depends
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <future>
 
+#include "BatchWrapper.h"
 #include "CodeGen_C.h"
 #include "CodeGen_Internal.h"
 #include "Debug.h"
@@ -511,6 +512,10 @@ void compile_multitarget(const std::string &fn_name,
                 break;
             }
         }
+        // The wrapper only dispatches the main entry point.
+        if (needs_wrapper && target.has_feature(Target::Batch)) {
+            user_error << "The batch feature is not supported by compile_multitarget with more than one Target.\n";
+        }
 
         // Each sub-target has a function name that is the 'real' name plus a suffix
         // (which defaults to the target string but can be customized via the suffixes map)
@@ -621,8 +626,13 @@ void compile_multitarget(const std::string &fn_name,
     if (!output_files.c_header_name.empty()) {
         Module header_module(fn_name, base_target);
         header_module.append(LoweredFunc(fn_name, base_target_args, {}, LoweredFunc::ExternalPlusMetadata));
+        const LoweredFunc main_fn = header_module.functions().back();
         // Add a wrapper to accept old buffer_ts
-        add_legacy_wrapper(header_module, header_module.functions().back());
+        add_legacy_wrapper(header_module, main_fn);
+        // And declare the batch entry point, if the sub-target has one
+        if (base_target.has_feature(Target::Batch)) {
+            add_batch_wrapper(header_module, main_fn, fn_name + "_batch_item");
+        }
         Outputs header_out = Outputs().c_header(output_files.c_header_name);
         futures.emplace_back(pool.async([](Module m, Outputs o) {
             debug(1) << "compile_multitarget: c_header_name " << o.c_header_name << "\n";
@@ -7,6 +7,8 @@
 #include "Substitute.h"
 #include "CSE.h"
 #include "IREquality.h"
+#include "Associativity.h"
+#include "ExprUsesVar.h"
 
 namespace Halide {
 namespace Internal {
@@ -164,6 +166,103 @@ bool can_parallelize_rvar(const string &v,
 
     return is_zero(hazard);
 }
+bool can_permute_rvars(const string &f,
+                       const Definition &r,
+                       bool *any_order) {
+    if (any_order) {
+        *any_order = false;
+    }
+    const vector<Expr> &values = r.values();
+    const vector<Expr> &args = r.args();
+    const vector<ReductionVariable> &rvars = r.schedule().rvars();
+
+    // Reductions like sums and maxima can be computed in any order.
+    AssociativeOp assoc = prove_associativity(f, args, values);
+    if (assoc.associative() && assoc.commutative()) {
+        debug(3) << "The update of " << f << " is a commutative reduction\n";
+        if (any_order) {
+            *any_order = true;
+        }
+        return true;
+    }
+
+    // Otherwise, find the dimension of the function that each
+    // reduction variable indexes. Distinct iterations of the reduction
+    // domain then store to distinct locations.
+    vector<int> dim(rvars.size(), -1);
+    for (size_t i = 0; i < rvars.size(); i++) {
+        for (size_t j = 0; j < args.size(); j++) {
+            const Variable *var = args[j].as<Variable>();
+            if (var && var->name == rvars[i].var) {
+                dim[i] = j;
+                break;
+            }
+        }
+        if (dim[i] < 0) {
+            return false;
+        }
+    }
+    for (size_t j = 0; j < args.size(); j++) {
+        if (std::find(dim.begin(), dim.end(), (int)j) != dim.end()) {
+            continue;
+        }
+        for (const auto &rv : rvars) {
+            if (expr_uses_var(args[j], rv.var)) {
+                return false;
+            }
+        }
+    }
+
+    FindLoads find(f);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i].accept(&find);
+    }
+    for (size_t i = 0; i < args.size(); i++) {
+        args[i].accept(&find);
+    }
+    if (r.predicate().defined()) {
+        r.predicate().accept(&find);
+    }
+
+    for (const auto &load : find.loads) {
+        internal_assert(load.size() == args.size());
+        // The dependence distance along each reduction variable, from
+        // the iteration that stores the loaded value to the iteration
+        // that loads it.
+        vector<int64_t> distance(rvars.size());
+        for (size_t j = 0; j < args.size(); j++) {
+            auto iter = std::find(dim.begin(), dim.end(), (int)j);
+            if (iter == dim.end()) {
+                if (!equal(load[j], args[j])) {
+                    return false;
+                }
+                continue;
+            }
+            const int64_t *d = as_const_int(simplify(args[j] - load[j]));
+            if (!d) {
+                return false;
+            }
+            distance[iter - dim.begin()] = *d;
+        }
+
+        // The dependence points forwards in the original loop order,
+        // whose outermost loop is over the last reduction variable. It
+        // still does in any other order if no component is negative.
+        int64_t sign = 0;
+        for (size_t i = rvars.size(); i > 0 && sign == 0; i--) {
+            sign = distance[i - 1];
+        }
+        for (int64_t d : distance) {
+            if ((sign < 0 && d > 0) || (sign > 0 && d < 0)) {
+                debug(3) << "The update of " << f << " has a dependence that "
+                         << "prevents reordering its reduction variables\n";
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
 
 }
 }
@@ -3,8 +3,9 @@
 
 /** \file
  *
- * Method for checking if it's safe to parallelize an update
- * definition across a reduction variable.
+ * Methods for checking if it's safe to parallelize an update
+ * definition across a reduction variable, or to reorder the loops
+ * over its reduction variables.
  */
 
 #include "Function.h"
@@ -21,6 +22,23 @@ bool can_parallelize_rvar(const std::string &rvar,
                           const std::string &func,
                           const Definition &r);
 
+/** Returns whether or not Halide can prove that it is safe to
+ * interchange and tile the loops over the reduction variables of an
+ * update definition. This is the case if the update is a commutative
+ * and associative reduction, in which case the loops may be reordered
+ * arbitrarily and 'any_order' is set to true. Otherwise it is the case
+ * if every reduction variable indexes its own dimension of the
+ * function, and every dependence between two iterations of the
+ * reduction domain is non-negative along all of them. Then the loops
+ * over different reduction variables may be interchanged, but the
+ * pieces of a split reduction variable must stay in order, and
+ * 'any_order' is set to false. As with can_parallelize_rvar, a false
+ * result only means Halide couldn't prove it.
+ */
+bool can_permute_rvars(const std::string &func,
+                       const Definition &r,
+                       bool *any_order = nullptr);
+
 }
 }
 
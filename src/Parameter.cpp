@@ -16,6 +16,7 @@ struct ParameterContents {
     Buffer<> buffer;
     uint64_t data;
     int host_alignment;
+    bool nontemporal_stores;
     std::vector<Expr> min_constraint;
     std::vector<Expr> extent_constraint;
     std::vector<Expr> stride_constraint;
@@ -30,7 +31,7 @@ struct ParameterContents {
     const bool is_bound_before_lowering;
     ParameterContents(Type t, bool b, int d, const std::string &n, bool e, bool r, bool is_bound_before_lowering)
         : type(t), dimensions(d), name(n), buffer(Buffer<>()), data(0),
-          host_alignment(t.bytes()), is_buffer(b), is_explicit_name(e), is_registered(r),
+          host_alignment(t.bytes()), nontemporal_stores(false), is_buffer(b), is_explicit_name(e), is_registered(r),
           is_bound_before_lowering(is_bound_before_lowering) {
 
         min_constraint.resize(dimensions);
@@ -289,6 +290,17 @@ int Parameter::host_alignment() const {
     check_is_buffer();
     return contents->host_alignment;
 }
+
+void Parameter::set_nontemporal_stores(bool nontemporal) {
+    check_is_buffer();
+    contents->nontemporal_stores = nontemporal;
+}
+
+bool Parameter::nontemporal_stores() const {
+    check_is_buffer();
+    return contents->nontemporal_stores;
+}
+
 void Parameter::set_min_value(Expr e) {
     check_is_scalar();
     if (e.defined()) {
@@ -138,6 +138,14 @@ public:
     EXPORT int host_alignment() const;
     //@}
 
+    /** Get and set whether vector stores to this buffer should be
+     * non-temporal, i.e. bypass the cache. Only meaningful for output
+     * buffers. */
+    // @{
+    EXPORT void set_nontemporal_stores(bool nontemporal);
+    EXPORT bool nontemporal_stores() const;
+    // @}
+
     /** Get and set constraints for scalar parameters. These are used
      * directly by Param, so they must be exported. */
     // @{
@@ -2,6 +2,7 @@
 
 #include "Pipeline.h"
 #include "Argument.h"
+#include "BatchWrapper.h"
 #include "FindCalls.h"
 #include "Func.h"
 #include "InferArguments.h"
@@ -384,6 +385,22 @@ Module Pipeline::compile_to_module(const vector<Argument> &args,
         }
 
         contents->module = lower(contents->outputs, new_fn_name, target, lowering_args, linkage_type, custom_passes);
+
+        // The batch entry point runs all but the first image of a
+        // batch with a version of the pipeline that has no argument
+        // checks or bounds queries.
+        if (target.has_feature(Target::Batch) && !target.has_feature(Target::JIT)) {
+            string item_fn_name = new_fn_name + "_batch_item";
+            Module item_module = lower(contents->outputs, item_fn_name, target.without_feature(Target::Batch),
+                                       lowering_args, LoweredFunc::Internal, custom_passes, true);
+            for (const LoweredFunc &f : item_module.functions()) {
+                // Skip the item's legacy buffer_t wrapper.
+                if (f.linkage == LoweredFunc::Internal) {
+                    contents->module.append(f);
+                }
+            }
+            add_batch_wrapper(contents->module, contents->module.get_function_by_name(new_fn_name), item_fn_name);
+        }
     }
 
     return contents->module;
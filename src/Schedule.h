@@ -41,8 +41,12 @@ enum class TailStrategy {
      * factored out into a loop epilogue if possible. Pros: no
      * redundant re-evaluation; does not constrain input our
      * output sizes. Cons: increases code size due to separate
-     * tail-case handling; vectorization will scalarize in the tail
-     * case to handle the if statement. */
+     * tail-case handling. If the target has masked vector loads
+     * and stores for the types involved (e.g. x86 with AVX-512, or
+     * AVX for 32 and 64-bit types), a vectorized tail case becomes
+     * a single iteration with predicated loads and stores;
+     * otherwise vectorization will scalarize in the tail case to
+     * handle the if statement. */
     GuardWithIf,
 
     /** Prevent evaluation beyond the original extent by shifting
@@ -277,6 +281,7 @@ struct StorageDim {
     Expr alignment;
     Expr fold_factor;
     bool fold_forward;
+    bool pad_critical_stride;
 };
 
 struct PrefetchDirective {
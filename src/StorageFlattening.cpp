@@ -141,6 +141,9 @@ private:
             Function f = iter->second.first;
             const vector<StorageDim> &storage_dims = f.schedule().storage_dims();
             const vector<string> &args = f.args();
+            // The number of elements spanned by the dimensions stored
+            // inside the current one.
+            Expr inner_elems = 1;
             for (size_t i = 0; i < storage_dims.size(); i++) {
                 for (size_t j = 0; j < args.size(); j++) {
                     if (args[j] == storage_dims[i].var) {
@@ -151,6 +154,21 @@ private:
                         } else {
                             allocation_extents[j] = extents[j];
                         }
+                        if (storage_dims[i].pad_critical_stride && i + 1 < storage_dims.size()) {
+                            // If the stride of the next dimension out is a
+                            // multiple of 1024 bytes, grow it by at least a
+                            // cache line.
+                            int bytes = op->types[0].bytes();
+                            Expr stride_bytes = cast<int64_t>(inner_elems) * allocation_extents[j] * bytes;
+                            Expr padding = max((64 / bytes) / inner_elems, 1);
+                            if (alignment.defined()) {
+                                padding = ((padding + alignment - 1)/alignment)*alignment;
+                            }
+                            allocation_extents[j] = select(stride_bytes % 1024 == 0,
+                                                           allocation_extents[j] + padding,
+                                                           allocation_extents[j]);
+                        }
+                        inner_elems *= allocation_extents[j];
                     }
                 }
                 internal_assert(storage_permutation.size() == i+1);
@@ -82,6 +82,11 @@ struct Target {
         AVX512_KNL = halide_target_feature_avx512_knl,
         AVX512_Skylake = halide_target_feature_avx512_skylake,
         AVX512_Cannonlake = halide_target_feature_avx512_cannonlake,
+        AVX512_VNNI = halide_target_feature_avx512_vnni,
+        CPUDispatch = halide_target_feature_cpu_dispatch,
+        Batch = halide_target_feature_batch,
+        LoopCarry = halide_target_feature_loop_carry,
+        AccumulateInRegisters = halide_target_feature_accumulate_in_registers,
         TraceLoads = halide_target_feature_trace_loads,
         TraceStores = halide_target_feature_trace_stores,
         TraceRealizations = halide_target_feature_trace_realizations,
@@ -249,6 +249,14 @@ class PredicateLoadStore : public IRMutator2 {
                 << "We are inside a hexagon loop, but the target doesn't have hexagon's features\n";
             return true;
         } else if (target.arch == Target::X86) {
+            if (target.features_any_of({Target::AVX512_Skylake, Target::AVX512_Cannonlake})) {
+                // AVX512BW has masked loads and stores for all lane sizes
+                return (bit_size * lanes >= 128);
+            } else if (target.features_any_of({Target::AVX512, Target::AVX512_KNL, Target::AVX, Target::AVX2})) {
+                // AVX512F and AVX (vmaskmov) have masked loads and
+                // stores for 32 and 64-bit lanes
+                return (bit_size == 32 || bit_size == 64) && (bit_size * lanes >= 128);
+            }
             // Should only attempt to predicate store/load if the lane size is
             // no less than 4
             return (bit_size == 32) && (lanes >= 4);
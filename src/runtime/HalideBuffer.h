@@ -15,6 +15,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <iostream>
+#include <thread>
 
 #include "HalideRuntime.h"
 
@@ -696,6 +697,16 @@ public:
         buf.host = (uint8_t *)((uintptr_t)(unaligned_ptr + alignment - 1) & ~(alignment - 1));
     }
 
+    /** Share ownership of host memory allocated elsewhere, which the
+     * host pointer of this Buffer points into (e.g. a memory-mapped
+     * file). The allocation's deallocate_fn is called on it once the
+     * last Buffer referring to it drops its reference. */
+    void adopt_allocation(AllocationHeader *allocation) {
+        assert(!owns_host_memory() && "Buffer already owns its host memory");
+        alloc = allocation;
+        alloc->ref_count++;
+    }
+
     /** Drop reference to any owned host or device memory, possibly
      * freeing it, if this buffer held the last reference to
      * it. Retains the shape of the buffer. Does nothing if this
@@ -997,9 +1008,13 @@ public:
      * sprite onto a framebuffer, you'll want to translate the sprite
      * to the correct location first like so: \code
      * framebuffer.copy_from(sprite.translated({x, y})); \endcode
+     *
+     * Dimensions that are contiguous in both Buffers are copied with
+     * a single memcpy. If 'threads' is greater than one, large copies
+     * are split across up to that many threads.
     */
     template<typename T2, int D2>
-    void copy_from(const Buffer<T2, D2> &other) {
+    void copy_from(const Buffer<T2, D2> &other, int threads = 1) {
         assert(!device_dirty() && "Cannot call Halide::Runtime::Buffer::copy_from on a device dirty destination.");
         assert(!other.device_dirty() && "Cannot call Halide::Runtime::Buffer::copy_from on a device dirty source.");
 
@@ -1020,29 +1035,23 @@ public:
             src.crop(i, min_coord, max_coord - min_coord + 1);
         }
 
+        flat_loop_nest_dim<2> *t =
+            (flat_loop_nest_dim<2> *)HALIDE_ALLOCA(std::max(dimensions(), 2) * sizeof(flat_loop_nest_dim<2>));
+        int d = dst.make_flat_loop_nest(t, src.raw_buffer());
+        uint8_t *ptrs[] = {(uint8_t *)dst.begin(), (uint8_t *)src.begin()};
+
         // If T is void, we need to do runtime dispatch to an
-        // appropriately-typed lambda. We're copying, so we only care
+        // appropriately-typed copy. We're copying, so we only care
         // about the element size.
-        if (type().bytes() == 1) {
-            using MemType = uint8_t;
-            auto &typed_dst = (Buffer<MemType, D> &)dst;
-            auto &typed_src = (Buffer<const MemType, D> &)src;
-            typed_dst.for_each_value([&](MemType &dst, MemType src) {dst = src;}, typed_src);
-        } else if (type().bytes() == 2) {
-            using MemType = uint16_t;
-            auto &typed_dst = (Buffer<MemType, D> &)dst;
-            auto &typed_src = (Buffer<const MemType, D> &)src;
-            typed_dst.for_each_value([&](MemType &dst, MemType src) {dst = src;}, typed_src);
-        } else if (type().bytes() == 4) {
-            using MemType = uint32_t;
-            auto &typed_dst = (Buffer<MemType, D> &)dst;
-            auto &typed_src = (Buffer<const MemType, D> &)src;
-            typed_dst.for_each_value([&](MemType &dst, MemType src) {dst = src;}, typed_src);
-        } else if (type().bytes() == 8) {
-            using MemType = uint64_t;
-            auto &typed_dst = (Buffer<MemType, D> &)dst;
-            auto &typed_src = (Buffer<const MemType, D> &)src;
-            typed_dst.for_each_value([&](MemType &dst, MemType src) {dst = src;}, typed_src);
+        const int bytes = type().bytes();
+        if (bytes == 1) {
+            for_each_block<2>(copy_block<uint8_t>, t, d, ptrs, bytes, threads);
+        } else if (bytes == 2) {
+            for_each_block<2>(copy_block<uint16_t>, t, d, ptrs, bytes, threads);
+        } else if (bytes == 4) {
+            for_each_block<2>(copy_block<uint32_t>, t, d, ptrs, bytes, threads);
+        } else if (bytes == 8) {
+            for_each_block<2>(copy_block<uint64_t>, t, d, ptrs, bytes, threads);
         } else {
             assert(false && "type().bytes() must be 1, 2, 4, or 8");
         }
@@ -1616,12 +1625,257 @@ public:
     }
     // @}
 
-    void fill(not_void_T val) {
+    /** Set every value in the buffer to the given value. Dense runs of
+     * values with all bytes equal (e.g. zero) are filled with
+     * memset. If 'threads' is greater than one, large fills are split
+     * across up to that many threads. */
+    void fill(not_void_T val, int threads = 1) {
         set_host_dirty();
-        for_each_value([=](T &v) {v = val;});
+        if (sizeof(not_void_T) == 1) {
+            fill_as<uint8_t>(val, threads);
+        } else if (sizeof(not_void_T) == 2) {
+            fill_as<uint16_t>(val, threads);
+        } else if (sizeof(not_void_T) == 4) {
+            fill_as<uint32_t>(val, threads);
+        } else if (sizeof(not_void_T) == 8) {
+            fill_as<uint64_t>(val, threads);
+        } else {
+            for_each_value([=](T &v) {v = val;});
+        }
     }
 
 private:
+    /** Helper functions for copy_from and fill. */
+    // @{
+    template<int N>
+    struct flat_loop_nest_dim {
+        int extent;
+        int stride[N];
+    };
+
+    // Make the loop nest for a copy or fill over this buffer and
+    // optionally one other buffer of the same shape. As in
+    // for_each_value, the dimensions are ordered by stride in this
+    // buffer, and dimensions that are contiguous in all the buffers
+    // are fused. Returns the number of dimensions, which is at least
+    // two, so that the innermost two can always be handled together.
+    template<int N>
+    int make_flat_loop_nest(flat_loop_nest_dim<N> *t, const halide_buffer_t *other) const {
+        int d = 0;
+        for (int i = 0; i < dimensions(); i++) {
+            if (dim(i).extent() == 1) {
+                continue;
+            }
+            t[d].extent = dim(i).extent();
+            t[d].stride[0] = dim(i).stride();
+            for (int j = 1; j < N; j++) {
+                t[d].stride[j] = other->dim[i].stride;
+            }
+            for (int j = d; j > 0 && t[j].stride[0] < t[j-1].stride[0]; j--) {
+                std::swap(t[j], t[j-1]);
+            }
+            d++;
+        }
+
+        for (int i = 1; i < d; i++) {
+            bool flat = true;
+            for (int j = 0; j < N; j++) {
+                flat = flat && t[i-1].stride[j] * t[i-1].extent == t[i].stride[j];
+            }
+            if (flat) {
+                t[i-1].extent *= t[i].extent;
+                for (int j = i; j < d - 1; j++) {
+                    t[j] = t[j+1];
+                }
+                i--;
+                d--;
+            }
+        }
+
+        for (; d < 2; d++) {
+            t[d].extent = 1;
+            for (int j = 0; j < N; j++) {
+                t[d].stride[j] = (d == 0) ? 1 : 0;
+            }
+        }
+        return d;
+    }
+
+    // Call a function on each 2D block of the innermost two dimensions
+    // of a flattened loop nest.
+    template<int N, typename Fn>
+    static void for_each_block(Fn &&f, const flat_loop_nest_dim<N> *t, int d, uint8_t *const *ptrs, int elem_size) {
+        if (d == 1) {
+            f(t, ptrs);
+            return;
+        }
+        uint8_t *p[N];
+        for (int j = 0; j < N; j++) {
+            p[j] = ptrs[j];
+        }
+        for (int i = t[d].extent; i != 0; i--) {
+            for_each_block<N>(f, t, d - 1, p, elem_size);
+            for (int j = 0; j < N; j++) {
+                p[j] += (int64_t)t[d].stride[j] * elem_size;
+            }
+        }
+    }
+
+    // The same, but with the loop nest split across up to the given
+    // number of threads, each of which does at least a few hundred
+    // kilobytes of work.
+    template<int N, typename Fn>
+    static void for_each_block(Fn &&f, const flat_loop_nest_dim<N> *t, int d, uint8_t *const *ptrs, int elem_size, int threads) {
+        const int64_t min_bytes_per_thread = 256 * 1024;
+        int64_t bytes = elem_size;
+        for (int i = 0; i < d; i++) {
+            bytes *= t[i].extent;
+        }
+        // Split the largest dimension other than the innermost one,
+        // unless the whole loop nest was fused into the innermost one.
+        int split = 1;
+        for (int i = 2; i < d; i++) {
+            if (t[i].extent > t[split].extent) {
+                split = i;
+            }
+        }
+        if (t[split].extent == 1) {
+            split = 0;
+        }
+        threads = (int)std::min(std::min((int64_t)threads, bytes / min_bytes_per_thread),
+                                (int64_t)t[split].extent);
+        if (threads <= 1) {
+            for_each_block<N>(f, t, d - 1, ptrs, elem_size);
+            return;
+        }
+
+        auto task = [&](int i) {
+            std::vector<flat_loop_nest_dim<N>> t_i(t, t + d);
+            int min = (int)((int64_t)t[split].extent * i / threads);
+            int max = (int)((int64_t)t[split].extent * (i + 1) / threads);
+            t_i[split].extent = max - min;
+            uint8_t *p[N];
+            for (int j = 0; j < N; j++) {
+                p[j] = ptrs[j] + (int64_t)min * t[split].stride[j] * elem_size;
+            }
+            for_each_block<N>(f, t_i.data(), d - 1, p, elem_size);
+        };
+        std::vector<std::thread> workers;
+        for (int i = 1; i < threads; i++) {
+            workers.emplace_back(task, i);
+        }
+        task(0);
+        for (auto &w : workers) {
+            w.join();
+        }
+    }
+
+    // Copy K channels from planar to interleaved, and back. The loops
+    // over channels are unrolled, so that the compiler can vectorize
+    // the loops over the values.
+    template<typename MemType, int K>
+    static void interleave(MemType *dst, const MemType *src, int n, int src_channel_stride) {
+        const MemType *s[K];
+        for (int c = 0; c < K; c++) {
+            s[c] = src + (int64_t)c * src_channel_stride;
+        }
+        for (int i = 0; i < n; i++) {
+            for (int c = 0; c < K; c++) {
+                dst[i * K + c] = s[c][i];
+            }
+        }
+    }
+
+    template<typename MemType, int K>
+    static void deinterleave(MemType *dst, const MemType *src, int n, int dst_channel_stride) {
+        MemType *d[K];
+        for (int c = 0; c < K; c++) {
+            d[c] = dst + (int64_t)c * dst_channel_stride;
+        }
+        for (int i = 0; i < n; i++) {
+            for (int c = 0; c < K; c++) {
+                d[c][i] = src[i * K + c];
+            }
+        }
+    }
+
+    template<typename MemType>
+    static void copy_block(const flat_loop_nest_dim<2> *t, uint8_t *const *ptrs) {
+        MemType *dst = (MemType *)ptrs[0];
+        const MemType *src = (const MemType *)ptrs[1];
+        const int n = t[0].extent, m = t[1].extent;
+        const int dst_stride = t[0].stride[0], src_stride = t[0].stride[1];
+
+        if (dst_stride == 1 && src_stride == 1) {
+            for (int i = 0; i < m; i++) {
+                memcpy(dst + (int64_t)i * t[1].stride[0], src + (int64_t)i * t[1].stride[1], n * sizeof(MemType));
+            }
+            return;
+        }
+
+        if (dst_stride == 1 && t[1].stride[1] == 1) {
+            // The innermost two dimensions are transposed, as in a copy
+            // between interleaved and planar layouts.
+            if (t[1].stride[0] == n && n >= 2 && n <= 4) {
+                switch (n) {
+                case 2: interleave<MemType, 2>(dst, src, m, src_stride); return;
+                case 3: interleave<MemType, 3>(dst, src, m, src_stride); return;
+                case 4: interleave<MemType, 4>(dst, src, m, src_stride); return;
+                }
+            } else if (src_stride == m && m >= 2 && m <= 4) {
+                switch (m) {
+                case 2: deinterleave<MemType, 2>(dst, src, n, t[1].stride[0]); return;
+                case 3: deinterleave<MemType, 3>(dst, src, n, t[1].stride[0]); return;
+                case 4: deinterleave<MemType, 4>(dst, src, n, t[1].stride[0]); return;
+                }
+            }
+        }
+
+        for (int i = 0; i < m; i++) {
+            MemType *d = dst + (int64_t)i * t[1].stride[0];
+            const MemType *s = src + (int64_t)i * t[1].stride[1];
+            for (int j = 0; j < n; j++) {
+                d[(int64_t)j * dst_stride] = s[(int64_t)j * src_stride];
+            }
+        }
+    }
+
+    template<typename MemType>
+    void fill_as(not_void_T val, int threads) {
+        MemType bits = 0;
+        memcpy(&bits, &val, std::min(sizeof(MemType), sizeof(not_void_T)));
+        // Check if the value can be stored with memset.
+        uint8_t byte = (uint8_t)bits;
+        bool splat = true;
+        for (size_t i = 1; i < sizeof(MemType); i++) {
+            splat = splat && (uint8_t)(bits >> (i * 8)) == byte;
+        }
+
+        flat_loop_nest_dim<1> *t =
+            (flat_loop_nest_dim<1> *)HALIDE_ALLOCA(std::max(dimensions(), 2) * sizeof(flat_loop_nest_dim<1>));
+        int d = make_flat_loop_nest(t, nullptr);
+        uint8_t *ptrs[] = {(uint8_t *)begin()};
+        auto fill_block = [=](const flat_loop_nest_dim<1> *block, uint8_t *const *p) {
+            const int n = block[0].extent, stride = block[0].stride[0];
+            for (int i = 0; i < block[1].extent; i++) {
+                MemType *dst = (MemType *)p[0] + (int64_t)i * block[1].stride[0];
+                if (stride == 1 && splat) {
+                    memset(dst, byte, n * sizeof(MemType));
+                } else if (stride == 1) {
+                    for (int j = 0; j < n; j++) {
+                        dst[j] = bits;
+                    }
+                } else {
+                    for (int j = 0; j < n; j++) {
+                        dst[(int64_t)j * stride] = bits;
+                    }
+                }
+            }
+        };
+        for_each_block<1>(fill_block, t, d, ptrs, sizeof(MemType), threads);
+    }
+    // @}
+
     /** Helper functions for for_each_value. */
     // @{
     template<int N>
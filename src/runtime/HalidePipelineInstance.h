@@ -0,0 +1,250 @@
+/** \file
+ * Defines a class that lets an AOT-compiled pipeline reuse the memory
+ * for its intermediate Funcs from one call to the next.
+ */
+
+#ifndef HALIDE_PIPELINE_INSTANCE_H
+#define HALIDE_PIPELINE_INSTANCE_H
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <set>
+#include <stdint.h>
+#include <vector>
+
+#include "HalideRuntime.h"
+
+namespace Halide {
+namespace Runtime {
+
+/** A PipelineInstance owns the scratch memory for the intermediates of
+ * a pipeline that is run many times with the same shapes, e.g. once per
+ * frame of a video. The first run allocates the intermediates as usual;
+ * on later runs, each halide_malloc is satisfied by a block of the same
+ * size left over from earlier runs, so runs with the same shapes don't
+ * allocate at all. Blocks that a run doesn't use (e.g. because the
+ * shapes changed) are released when it returns.
+ *
+ * The pipeline must be compiled with the user_context target feature:
+ * the instance passes itself as the user_context, and installs a custom
+ * halide_malloc and halide_free (via halide_set_custom_malloc and
+ * halide_set_custom_free) that recognize it, while any instances exist.
+ * Allocations with any other user_context go to whatever handlers were
+ * installed before the first instance was created, which are restored
+ * when the last one is destroyed.
+ *
+ * Runs of one instance are serialized; use one instance per thread to
+ * run a pipeline concurrently. Generators can emit a typed wrapper
+ * around this class for a pipeline with "-e instance"; see
+ * Generator.cpp.
+ */
+class PipelineInstance {
+    struct Block {
+        void *ptr;
+        size_t size;
+        bool in_use, used_this_run;
+    };
+
+    std::mutex run_mutex, blocks_mutex;
+    std::vector<Block> blocks;
+    uint64_t allocations = 0;
+
+    // Every halide_malloc and halide_free goes through find while any
+    // instance exists, so it doesn't take the mutex unless there are
+    // more instances than fit in 'fast', or the handlers are still
+    // being installed.
+    static const int max_fast_instances = 16;
+
+    struct Registry {
+        std::mutex mutex;
+        int count = 0;
+        std::atomic<const PipelineInstance *> fast[max_fast_instances];
+        std::set<const PipelineInstance *> slow;
+        std::atomic<int> slow_count;
+        std::atomic<halide_malloc_t> old_malloc;
+        std::atomic<halide_free_t> old_free;
+
+        Registry() : slow_count(0), old_malloc(nullptr), old_free(nullptr) {
+            for (auto &f : fast) {
+                f = nullptr;
+            }
+        }
+    };
+
+    static Registry &registry() {
+        static Registry r;
+        return r;
+    }
+
+    // Returns the instance if user_context is one; otherwise sets
+    // *old_malloc and *old_free to the handlers to defer to.
+    static PipelineInstance *find(void *user_context, halide_malloc_t *old_malloc, halide_free_t *old_free) {
+        Registry &r = registry();
+        const PipelineInstance *p = (const PipelineInstance *)user_context;
+        if (p) {
+            for (const auto &f : r.fast) {
+                if (f == p) {
+                    return (PipelineInstance *)p;
+                }
+            }
+        }
+        *old_malloc = r.old_malloc;
+        *old_free = r.old_free;
+        if (r.slow_count == 0 && *old_malloc && *old_free) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (r.slow.count(p)) {
+            return (PipelineInstance *)p;
+        }
+        *old_malloc = r.old_malloc;
+        *old_free = r.old_free;
+        return nullptr;
+    }
+
+    static void *instance_malloc(void *user_context, size_t size) {
+        halide_malloc_t old_malloc = nullptr;
+        halide_free_t old_free = nullptr;
+        PipelineInstance *instance = find(user_context, &old_malloc, &old_free);
+        return instance ? instance->allocate(size) : old_malloc(user_context, size);
+    }
+
+    static void instance_free(void *user_context, void *ptr) {
+        halide_malloc_t old_malloc = nullptr;
+        halide_free_t old_free = nullptr;
+        PipelineInstance *instance = find(user_context, &old_malloc, &old_free);
+        if (instance) {
+            instance->release(ptr);
+        } else {
+            old_free(user_context, ptr);
+        }
+    }
+
+    void *allocate(size_t size) {
+        std::lock_guard<std::mutex> lock(blocks_mutex);
+        for (Block &b : blocks) {
+            if (!b.in_use && b.size == size) {
+                b.in_use = b.used_this_run = true;
+                return b.ptr;
+            }
+        }
+        // The handlers we replaced don't know about instances, so
+        // don't pass them one as the user_context.
+        void *ptr = registry().old_malloc(nullptr, size);
+        if (ptr) {
+            blocks.push_back({ptr, size, true, true});
+            allocations++;
+        }
+        return ptr;
+    }
+
+    void release(void *ptr) {
+        std::lock_guard<std::mutex> lock(blocks_mutex);
+        for (Block &b : blocks) {
+            if (b.ptr == ptr) {
+                b.in_use = false;
+                return;
+            }
+        }
+        registry().old_free(nullptr, ptr);
+    }
+
+    // Free the blocks that weren't used since the last call to
+    // start_run (or all of them).
+    void free_blocks(bool only_unused) {
+        std::lock_guard<std::mutex> lock(blocks_mutex);
+        auto unused = [&](const Block &b) {
+            if (b.in_use || (only_unused && b.used_this_run)) {
+                return false;
+            }
+            registry().old_free(nullptr, b.ptr);
+            return true;
+        };
+        blocks.erase(std::remove_if(blocks.begin(), blocks.end(), unused), blocks.end());
+    }
+
+public:
+    PipelineInstance() {
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        if (r.count++ == 0) {
+            // Until these are set, find takes the mutex to read them.
+            // They are kept after the last instance is destroyed, as a
+            // call that started before then may still read them.
+            r.old_malloc = halide_set_custom_malloc(instance_malloc);
+            r.old_free = halide_set_custom_free(instance_free);
+        }
+        for (auto &f : r.fast) {
+            if (f == nullptr) {
+                f = this;
+                return;
+            }
+        }
+        r.slow.insert(this);
+        r.slow_count++;
+    }
+
+    ~PipelineInstance() {
+        free_blocks(false);
+        Registry &r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        bool was_fast = false;
+        for (auto &f : r.fast) {
+            if (f == this) {
+                f = nullptr;
+                was_fast = true;
+            }
+        }
+        if (!was_fast) {
+            r.slow.erase(this);
+            r.slow_count--;
+        }
+        if (--r.count == 0) {
+            halide_set_custom_malloc(r.old_malloc);
+            halide_set_custom_free(r.old_free);
+        }
+    }
+
+    PipelineInstance(const PipelineInstance &) = delete;
+    PipelineInstance &operator=(const PipelineInstance &) = delete;
+
+    /** Run a pipeline, by calling f with the user_context to pass to
+     * it, and return what f returns. */
+    template<typename Fn>
+    int run(Fn &&f) {
+        std::lock_guard<std::mutex> lock(run_mutex);
+        {
+            std::lock_guard<std::mutex> blocks_lock(blocks_mutex);
+            for (Block &b : blocks) {
+                b.used_this_run = false;
+            }
+        }
+        int result = f((void *)this);
+        free_blocks(true);
+        return result;
+    }
+
+    /** The number of bytes of scratch memory currently held. */
+    size_t scratch_bytes() {
+        std::lock_guard<std::mutex> lock(blocks_mutex);
+        size_t total = 0;
+        for (const Block &b : blocks) {
+            total += b.size;
+        }
+        return total;
+    }
+
+    /** The number of blocks of scratch memory that have been allocated
+     * over the lifetime of this instance. If this stays the same from
+     * one run to the next, the second run allocated nothing. */
+    uint64_t total_allocations() {
+        std::lock_guard<std::mutex> lock(blocks_mutex);
+        return allocations;
+    }
+};
+
+}  // namespace Runtime
+}  // namespace Halide
+
+#endif  // HALIDE_PIPELINE_INSTANCE_H
@@ -317,6 +317,9 @@ struct halide_type_t {
 #endif
 };
 
+// The C backend's preamble already defines these (along with inline
+// versions of the functions below) before it pastes in this header.
+#ifndef RUNTIME_FIXMATH_H
 typedef int32_t fix16_t;
 
 const fix16_t FOUR_DIV_PI  = 0x145F3;            /*!< Fix16 value of 4/PI */
@@ -332,6 +335,7 @@ const fix16_t fix16_overflow = 0x80000000; /*!< the value used to indicate overf
 const fix16_t fix16_pi  = 205887;     /*!< fix16_t value of pi */
 const fix16_t fix16_e   = 178145;     /*!< fix16_t value of e */
 const fix16_t fix16_one = 0x00010000; /*!< fix16_t value of 1 */
+#endif
 
 extern float halide_fix16_to_float(fix16_t a);
 extern fix16_t halide_fix16_from_float(float a);
@@ -950,6 +954,11 @@ enum halide_error_code_t {
      * existed on a different device interface. Free the old one
      * first. */
     halide_error_code_incompatible_device_interface = -42,
+
+    /** A buffer with the device_dirty flag set was passed to a
+     * pipeline compiled with no device backends, so it cannot be
+     * copied back to the host. Call device_sync first. */
+    halide_error_code_device_dirty_with_no_device_support = -43,
 };
 
 /** Halide calls the functions below on various error conditions. The
@@ -1026,6 +1035,7 @@ extern int halide_error_no_device_interface(void *user_context);
 extern int halide_error_device_interface_no_device(void *user_context);
 extern int halide_error_host_and_device_dirty(void *user_context);
 extern int halide_error_buffer_is_null(void *user_context, const char *routine);
+extern int halide_error_device_dirty_with_no_device_support(void *user_context, const char *buffer_name);
 
 // @}
 
@@ -1095,7 +1105,12 @@ typedef enum halide_target_feature_t {
     halide_target_feature_cuda_capability61 = 46,  ///< Enable CUDA compute capability 6.1 (Pascal)
     halide_target_feature_hvx_v65 = 47, ///< Enable Hexagon v65 architecture.
     halide_target_feature_hvx_v66 = 48, ///< Enable Hexagon v66 architecture.
-    halide_target_feature_end = 49, ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
+    halide_target_feature_avx512_vnni = 49, ///< Enable the AVX512-VNNI dot product instructions (vpdpbusd, vpdpwssd), as found on Cascade Lake processors. This should be combined with the AVX512 Skylake or Cannonlake feature set.
+    halide_target_feature_cpu_dispatch = 50, ///< Also compile the loop nests that contain vector code for newer x86 instruction sets (SSE4.1, AVX2, AVX512 Skylake) than the target has, and pick the best version the host supports at runtime.
+    halide_target_feature_batch = 51, ///< Also generate a NAME_batch() entry point that runs the pipeline over arrays of identically-shaped buffers, checking the arguments once.
+    halide_target_feature_loop_carry = 52, ///< On x86 and ARM, keep values loaded by one iteration of a serial loop in registers for the next iterations that load them again. Hexagon always does this.
+    halide_target_feature_accumulate_in_registers = 53, ///< Hold the accumulators of reductions in registers across the innermost loop over the reduction domain.
+    halide_target_feature_end = 54, ///< A sentinel. Every target is considered to have this feature, and setting this feature does nothing.
 } halide_target_feature_t;
 
 /** This function is called internally by Halide in some situations to determine
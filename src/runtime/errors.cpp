@@ -277,4 +277,11 @@ WEAK int halide_error_buffer_is_null(void *user_context, const char *routine) {
     return halide_error_code_buffer_is_null;
 }
 
+WEAK int halide_error_device_dirty_with_no_device_support(void *user_context, const char *buffer_name) {
+    error(user_context) << "The device_dirty flag of " << buffer_name
+                        << " is set, but the pipeline has no device support"
+                        << " to copy it back to the host with.\n";
+    return halide_error_code_device_dirty_with_no_device_support;
+}
+
 }  // extern "C"
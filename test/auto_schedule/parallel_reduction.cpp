@@ -0,0 +1,67 @@
+#include "Halide.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    const int W = 2048, H = 2048;
+
+    Buffer<uint8_t> in(W, H);
+    for (int y = 0; y < in.height(); y++) {
+        for (int x = 0; x < in.width(); x++) {
+            in(x, y) = rand() & 0xff;
+        }
+    }
+
+    Var x("x");
+    RDom r(0, W, 0, H);
+
+    // A histogram of the whole image. The update has no pure dimensions to
+    // parallelize over, so the auto-scheduler has to rfactor the reduction.
+    Func hist("hist");
+    hist(x) = 0;
+    hist(in(r.x, r.y)) += 1;
+
+    // A scalar reduction over the whole image.
+    Func total("total");
+    total() = cast<int64_t>(0);
+    total() += cast<int64_t>(in(r.x, r.y)) * in(r.x, r.y);
+
+    hist.estimate(x, 0, 256);
+
+    Target target = get_jit_target_from_environment();
+    Pipeline p({hist, total});
+    std::string schedule = p.auto_schedule(target);
+
+    if (schedule.find("rfactor") == std::string::npos) {
+        printf("Expected the reductions to be rfactored:\n%s\n", schedule.c_str());
+        return -1;
+    }
+
+    Buffer<int> hist_buf(256);
+    Buffer<int64_t> total_buf = Buffer<int64_t>::make_scalar();
+    p.realize({hist_buf, total_buf});
+
+    int correct_hist[256] = {0};
+    int64_t correct_total = 0;
+    for (int y = 0; y < in.height(); y++) {
+        for (int x = 0; x < in.width(); x++) {
+            correct_hist[in(x, y)]++;
+            correct_total += (int64_t)in(x, y) * in(x, y);
+        }
+    }
+
+    for (int i = 0; i < 256; i++) {
+        if (hist_buf(i) != correct_hist[i]) {
+            printf("hist(%d) = %d instead of %d\n", i, hist_buf(i), correct_hist[i]);
+            return -1;
+        }
+    }
+    if (total_buf() != correct_total) {
+        printf("total = %lld instead of %lld\n",
+               (long long)total_buf(), (long long)correct_total);
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
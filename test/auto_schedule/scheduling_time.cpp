@@ -0,0 +1,78 @@
+#include "Halide.h"
+
+#include <chrono>
+#include <regex>
+
+using namespace Halide;
+
+// Build a deep pipeline of stencils, where every few stages also reach back
+// to an earlier stage, so that many grouping choices have to be evaluated.
+Func build_pipeline(Buffer<float> input, int num_stages) {
+    Var x("x"), y("y");
+
+    Func in_b = BoundaryConditions::repeat_edge(input);
+
+    std::vector<Func> stages;
+    stages.push_back(in_b);
+    for (int i = 1; i <= num_stages; i++) {
+        Func prev = stages.back();
+        Func f("f" + std::to_string(i));
+        if (i % 2) {
+            f(x, y) = (prev(x - 1, y) + 2 * prev(x, y) + prev(x + 1, y)) / 4;
+        } else {
+            f(x, y) = (prev(x, y - 1) + 2 * prev(x, y) + prev(x, y + 1)) / 4;
+        }
+        if (i % 5 == 0) {
+            Func back = stages[i - 4];
+            f(x, y) = f(x, y) - back(x, y) / 2;
+        }
+        stages.push_back(f);
+    }
+
+    Func out("out");
+    out(x, y) = stages.back()(x, y);
+    out.estimate(x, 0, input.width()).estimate(y, 0, input.height());
+    return out;
+}
+
+int main(int argc, char **argv) {
+    const int num_stages = 50;
+
+    Buffer<float> input(1536, 2560);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = rand() & 0xfff;
+        }
+    }
+
+    Target target = get_jit_target_from_environment();
+
+    // Time the auto-scheduler itself, on two identical copies of the
+    // pipeline. Grouping choices are evaluated on multiple threads, which
+    // must not change the schedule that gets picked.
+    std::string schedules[2];
+    for (int i = 0; i < 2; i++) {
+        Pipeline p(build_pipeline(input, num_stages));
+
+        auto start = std::chrono::high_resolution_clock::now();
+        schedules[i] = p.auto_schedule(target);
+        auto end = std::chrono::high_resolution_clock::now();
+
+        double ms = std::chrono::duration<double, std::milli>(end - start).count();
+        printf("Auto-scheduling %d stages took %f ms\n", num_stages, ms);
+    }
+
+    // The two copies of the pipeline only differ in the unique suffixes
+    // of their Func names.
+    for (std::string &s : schedules) {
+        s = std::regex_replace(s, std::regex("_[0-9]+\\b"), "");
+    }
+    if (schedules[0] != schedules[1]) {
+        printf("Auto-scheduler is not deterministic:\n%s\nvs\n%s\n",
+               schedules[0].c_str(), schedules[1].c_str());
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,107 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+using namespace Halide::Internal;
+
+// Counts the stack allocations made by accumulate_in_registers.
+class CountAccumulators : public IRMutator2 {
+    using IRMutator2::visit;
+
+    Stmt visit(const Allocate *op) override {
+        if (op->name.find(".accumulator") != std::string::npos) {
+            count++;
+        }
+        return IRMutator2::visit(op);
+    }
+
+public:
+    int count = 0;
+};
+
+const int K = 100;
+
+// Accumulate into g at x and at x + offset, with two vectors of x
+// and both offsets unrolled into the loop over the reduction domain,
+// so that the loop stores to four loop-invariant indices of g.
+bool test(const char *name, Expr offset, int offset_value, bool expect_accumulators) {
+    Buffer<int> in(K);
+    in.for_each_element([&](int i) { in(i) = i * 3 + 1; });
+
+    Var x;
+    RVar xo, xi, xu, xv;
+    RDom r(0, 32, 0, 2, 0, K);
+    Func g, out;
+    g(x) = x;
+    g(r.x + r.y * offset) += in(r.z);
+    out(x) = g(x);
+
+    g.compute_root();
+    // The lanes of each vector store to distinct elements of g, so
+    // vectorizing r.x doesn't race.
+    g.update()
+        .allow_race_conditions()
+        .split(r.x, xo, xi, 16).split(xi, xu, xv, 8)
+        .reorder(xv, xu, r.y, r.z, xo)
+        .vectorize(xv).unroll(xu).unroll(r.y);
+
+    CountAccumulators counter;
+    out.add_custom_lowering_pass(&counter, nullptr);
+
+    Target t = get_jit_target_from_environment().with_feature(Target::AccumulateInRegisters);
+    Buffer<int> result = out.realize(32, t);
+
+    if (expect_accumulators != (counter.count > 0)) {
+        printf("%s: expected %s accumulators\n", name, expect_accumulators ? "some" : "no");
+        return false;
+    }
+
+    int sum = 0;
+    for (int i = 0; i < K; i++) {
+        sum += in(i);
+    }
+    int correct[32 * 2];
+    for (int i = 0; i < 32 * 2; i++) {
+        correct[i] = i;
+    }
+    for (int i = 0; i < 32; i++) {
+        correct[i] += sum;
+        correct[i + offset_value] += sum;
+    }
+    for (int i = 0; i < 32; i++) {
+        if (result(i) != correct[i]) {
+            printf("%s: result(%d) = %d instead of %d\n", name, i, result(i), correct[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    // The vectors are a vector width apart, so they don't overlap.
+    if (!test("disjoint", 8, 8, true)) {
+        return -1;
+    }
+
+    // The vectors overlap.
+    if (!test("overlapping", 4, 4, false)) {
+        return -1;
+    }
+
+    // The indices are equal when the param is zero.
+    Param<int> p;
+    p.set(0);
+    if (!test("aliasing param", p, 0, false)) {
+        return -1;
+    }
+
+    // The indices depend on a load, and are equal.
+    Buffer<int> offsets(1);
+    offsets(0) = 0;
+    if (!test("aliasing load", clamp(offsets(Expr(0)), 0, 16), 0, false)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
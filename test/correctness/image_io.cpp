@@ -42,6 +42,67 @@ void test_round_trip(Buffer<T> buf, std::string format) {
     }
 }
 
+// Check that two images of the same shape have the same values.
+template<typename T>
+bool same_values(Buffer<T> a, Buffer<T> b) {
+    bool same = true;
+    a.for_each_element([&](const int *pos) {
+        same = same && a(pos) == b(pos);
+    });
+    return same;
+}
+
+template<typename T>
+void test_mapped_round_trip(Buffer<T> buf, std::string format) {
+    std::ostringstream o;
+    o << Internal::get_test_tmp_dir() << "test_mapped_" << halide_type_of<T>() << "x" << buf.channels() << "." << format;
+    std::string filename = o.str();
+    Tools::save_image(buf, filename);
+
+    // Load it by mapping the file.
+    Buffer<T> mapped;
+    if (!Tools::load_mapped(filename, &mapped)) {
+        printf("test_mapped_round_trip: Could not map %s\n", filename.c_str());
+        abort();
+    }
+    for (int d = 0; d < buf.dimensions(); ++d) {
+        mapped.translate(d, buf.dim(d).min() - mapped.dim(d).min());
+    }
+    if (!same_values(buf, mapped)) {
+        printf("test_mapped_round_trip: Mapped %s does not match what was saved\n", format.c_str());
+        abort();
+    }
+
+    // Write an image directly into a mapped file, and load it back.
+    if (format == "mat" ||
+        ((format == "pgm" || format == "ppm") && halide_type_of<T>() != halide_type_of<uint8_t>())) {
+        return;
+    }
+    std::vector<int> extents;
+    for (int d = 0; d < buf.dimensions(); ++d) {
+        extents.push_back(buf.dim(d).extent());
+    }
+    {
+        Buffer<T> out;
+        if (!Tools::create_mapped(filename, halide_type_of<T>(), extents, &out)) {
+            printf("test_mapped_round_trip: Could not map %s for writing\n", filename.c_str());
+            abort();
+        }
+        for (int d = 0; d < buf.dimensions(); ++d) {
+            out.translate(d, buf.dim(d).min());
+        }
+        out.copy_from(buf);
+    }
+    Buffer<T> reloaded = Tools::load_image(filename);
+    for (int d = 0; d < buf.dimensions(); ++d) {
+        reloaded.translate(d, buf.dim(d).min() - reloaded.dim(d).min());
+    }
+    if (!same_values(buf, reloaded)) {
+        printf("test_mapped_round_trip: %s written through a mapping does not match\n", format.c_str());
+        abort();
+    }
+}
+
 // static -> static conversion test
 template<typename T>
 void test_convert_image_s2s(Buffer<T> buf) {
@@ -181,7 +242,7 @@ void do_test() {
     luma_buf.copy_from(color_buf);
     luma_buf.slice(2, 0);
 
-    std::vector<std::string> formats = {"ppm","pgm","tmp","mat"};
+    std::vector<std::string> formats = {"ppm","pgm","tmp","mat","tiff"};
 #ifndef HALIDE_NO_JPEG
     formats.push_back("jpg");
 #endif
@@ -198,17 +259,24 @@ void do_test() {
             Buffer<T> cb4 = color_buf.embedded(color_buf.dimensions(), 0);
             std::cout << "Testing format: " << format << " for " << halide_type_of<T>() << "x4\n";
             test_round_trip(cb4, format);
+            test_mapped_round_trip(cb4, format);
             continue;
         }
         if (format != "pgm") {
             std::cout << "Testing format: " << format << " for " << halide_type_of<T>() << "x3\n";
             // pgm really only supports gray images.
             test_round_trip(color_buf, format);
+            if (format != "jpg" && format != "png") {
+                test_mapped_round_trip(color_buf, format);
+            }
         }
         if (format != "ppm") {
             std::cout << "Testing format: " << format << " for " << halide_type_of<T>() << "x1\n";
             // ppm really only supports RGB images.
             test_round_trip(luma_buf, format);
+            if (format != "jpg" && format != "png") {
+                test_mapped_round_trip(luma_buf, format);
+            }
         }
     }
 }
@@ -0,0 +1,87 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+// Check that the loops over RVars can be interchanged and tiled when
+// it doesn't change the meaning of the update definition, and that
+// doing so gives the same results as the original loop order.
+
+int check(Func f, Func g, int w, int h) {
+    Buffer<int> f_im = f.realize(w, h);
+    Buffer<int> g_im = g.realize(w, h);
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            if (f_im(x, y) != g_im(x, y)) {
+                printf("%s(%d, %d) = %d instead of %d\n",
+                       g.name().c_str(), x, y, g_im(x, y), f_im(x, y));
+                return -1;
+            }
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    Var x("x"), y("y");
+
+    // A recurrence in which each element depends on its neighbors above
+    // and to the left. Every dependence is non-negative along both RVars,
+    // so their loops can be interchanged and tiled.
+    {
+        Func f("f"), g("g");
+        RDom r(1, 99, 1, 99);
+        for (Func h : {f, g}) {
+            h(x, y) = x - y;
+            h(r.x, r.y) = (h(r.x - 1, r.y) + 3 * h(r.x, r.y - 1)) % 1000;
+        }
+
+        RVar rxi("rxi"), ryi("ryi");
+        g.update().tile(r.x, r.y, rxi, ryi, 8, 8);
+
+        if (check(f, g, 100, 100)) {
+            return -1;
+        }
+    }
+
+    // The same, but with the loop over y outermost.
+    {
+        Func f("f"), g("g");
+        RDom r(1, 99, 1, 99);
+        for (Func h : {f, g}) {
+            h(x, y) = x * y + x;
+            h(r.x, r.y) = (h(r.x - 1, r.y - 1) + h(r.x, r.y - 1)) % 1000;
+        }
+
+        g.update().reorder(r.y, r.x);
+
+        if (check(f, g, 100, 100)) {
+            return -1;
+        }
+    }
+
+    // A sum can be computed in any order, including with the pieces of
+    // a split RVar reversed.
+    {
+        Func input("input");
+        input(x, y) = x * 17 + y;
+
+        Func f("f"), g("g");
+        RDom r(0, 64, 0, 50);
+        for (Func h : {f, g}) {
+            h(x, y) = 0;
+            h(x, y) += input(r.y + x, r.x + y);
+        }
+
+        RVar rxo("rxo"), rxi("rxi");
+        g.update().split(r.x, rxo, rxi, 8).reorder(rxo, r.y, rxi, x, y);
+        input.compute_root();
+
+        if (check(f, g, 10, 10)) {
+            return -1;
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -51,6 +51,7 @@ struct Test {
     bool use_avx512_cannonlake{false};
     bool use_avx512_knl{false};
     bool use_avx512_skylake{false};
+    bool use_avx512_vnni{false};
     bool use_avx{false};
     bool use_power_arch_2_07{false};
     bool use_sse41{false};
@@ -86,6 +87,7 @@ struct Test {
         use_avx512_knl = target.has_feature(Target::AVX512_KNL);
         use_avx512_cannonlake = target.has_feature(Target::AVX512_Cannonlake);
         use_avx512_skylake = use_avx512_cannonlake || target.has_feature(Target::AVX512_Skylake);
+        use_avx512_vnni = use_avx512_skylake && target.has_feature(Target::AVX512_VNNI);
         use_avx512 = use_avx512_knl || use_avx512_skylake || use_avx512_cannonlake || target.has_feature(Target::AVX512);
         use_avx2 = use_avx512 || target.has_feature(Target::AVX2);
         use_avx = use_avx2 || target.has_feature(Target::AVX);
@@ -652,6 +654,23 @@ struct Test {
             check("vpminuq", 8, min(u64_1, u64_2));
             check("vpmaxsq", 8, max(i64_1, i64_2));
             check("vpminsq", 8, min(i64_1, i64_2));
+
+            check("vpmaddwd*zmm", 16, i32(i16_1) * 3 + i32(i16_2) * 4);
+        }
+        if (use_avx512_vnni) {
+            // Dot products of adjacent elements, with and without an accumulator.
+            for (int w = 1; w <= 4; w *= 2) {
+                Expr u8_dot = (i32(in_u8(4*x)) * in_i8(4*x) +
+                               i32(in_u8(4*x + 1)) * in_i8(4*x + 1) +
+                               i32(in_u8(4*x + 2)) * in_i8(4*x + 2) +
+                               i32(in_u8(4*x + 3)) * in_i8(4*x + 3));
+                check("vpdpbusd", 4*w, u8_dot);
+                check("vpdpbusd", 4*w, i32_1 + u8_dot);
+
+                Expr i16_dot = (i32(in_i16(2*x)) * in_i16(2*x + 32) +
+                                i32(in_i16(2*x + 1)) * in_i16(2*x + 33));
+                check("vpdpwssd", 4*w, i32_1 + i16_dot);
+            }
         }
     }
 
@@ -0,0 +1,63 @@
+#include "Halide.h"
+// Avoid the need to link this test to libjpeg and libpng
+#define HALIDE_NO_JPEG
+#define HALIDE_NO_PNG
+#include "halide_stream_io.h"
+#include <stdio.h>
+
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+#ifdef _WIN32
+    printf("Skipping test: memory-mapped files are not supported on Windows\n");
+    return 0;
+#endif
+
+    const int width = 123, height = 100;
+    Buffer<uint8_t> in(width, height, 3);
+    in.for_each_value([](uint8_t &v) { v = rand(); });
+
+    std::string in_ppm = Internal::get_test_tmp_dir() + "stream_in.ppm";
+    std::string out_ppm = Internal::get_test_tmp_dir() + "stream_out.ppm";
+    Tools::save_image(in, in_ppm);
+
+    // A blur, with a boundary condition that doesn't depend on the
+    // bounds of the input strip.
+    ImageParam input(UInt(8), 3);
+    Func clamped = BoundaryConditions::repeat_edge(input, {{0, width}, {0, height}, {0, 3}});
+    Func blur("blur");
+    Var x, y, c;
+    Expr sum = (cast<uint16_t>(clamped(x - 1, y - 2, c)) + clamped(x, y, c) +
+                clamped(x + 1, y + 2, c) + clamped(x, y + 5, c));
+    blur(x, y, c) = cast<uint8_t>(sum / 4);
+    blur.parallel(y).vectorize(x, 8);
+    Pipeline p(blur);
+
+    input.set(in);
+    Buffer<uint8_t> correct = p.realize(width, height, 3);
+    input.reset();
+
+    // Use a strip height that doesn't divide the image.
+    if (!Tools::stream_image(p, input, in_ppm, out_ppm, {}, 7)) {
+        printf("stream_image failed\n");
+        return -1;
+    }
+
+    Buffer<uint8_t> out = Tools::load_image(out_ppm);
+    for (int c = 0; c < 3; c++) {
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++) {
+                if (out(x, y, c) != correct(x, y, c)) {
+                    printf("out(%d, %d, %d) = %d instead of %d\n",
+                           x, y, c, out(x, y, c), correct(x, y, c));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    printf("Success!\n");
+    return 0;
+}
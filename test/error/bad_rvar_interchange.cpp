@@ -0,0 +1,22 @@
+#include "Halide.h"
+#include <stdio.h>
+
+using namespace Halide;
+
+int main(int argc, char **argv) {
+    RDom r(1, 9, 0, 9);
+
+    Func f("f");
+    Var x, y;
+    f(x, y) = x + y;
+    f(r.x, r.y) = f(r.x - 1, r.y + 1) * 2;
+
+    // Each iteration depends on one that is later along r.y, so the
+    // loops over r.x and r.y can't be interchanged.
+    f.update().reorder(r.y, r.x);
+
+    f.realize(10, 10);
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "HalideRuntime.h"
+#include "HalideBuffer.h"
+#include "batch.h"
+
+using namespace Halide::Runtime;
+
+static int errors = 0;
+
+void my_error_handler(void *user_context, const char *msg) {
+    errors++;
+}
+
+bool check(const Buffer<float> &input, float offset, const Buffer<float> &output) {
+    bool ok = true;
+    output.for_each_element([&](int x, int y) {
+        float correct = 2 * (input(x, y) + input(x + 1, y + 1)) + offset;
+        if (ok && output(x, y) != correct) {
+            printf("output(%d, %d) = %f instead of %f\n", x, y, output(x, y), correct);
+            ok = false;
+        }
+    });
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    halide_set_error_handler(my_error_handler);
+
+    const int batch_size = 8, W = 32, H = 16;
+    const float offset = 3.0f;
+    std::vector<Buffer<float>> inputs, outputs;
+    std::vector<halide_buffer_t *> input_ptrs, output_ptrs;
+    for (int i = 0; i < batch_size; i++) {
+        inputs.emplace_back(W + 1, H + 1);
+        inputs[i].for_each_element([&](int x, int y) {
+            inputs[i](x, y) = (float)(x + y * 10 + i * 1000);
+        });
+        outputs.emplace_back(W, H);
+    }
+    for (int i = 0; i < batch_size; i++) {
+        input_ptrs.push_back(inputs[i].raw_buffer());
+        output_ptrs.push_back(outputs[i].raw_buffer());
+    }
+
+    // Every image in the batch should get the same result as running
+    // the pipeline on it alone.
+    int result = batch_batch(batch_size, input_ptrs.data(), offset, output_ptrs.data());
+    if (result != 0) {
+        printf("batch_batch failed with error %d\n", result);
+        return -1;
+    }
+    for (int i = 0; i < batch_size; i++) {
+        if (!check(inputs[i], offset, outputs[i])) {
+            printf("Wrong result for image %d\n", i);
+            return -1;
+        }
+    }
+
+    // An empty batch does nothing.
+    if (batch_batch(0, nullptr, offset, nullptr) != 0) {
+        printf("Empty batch failed\n");
+        return -1;
+    }
+
+    // An image with a different shape from the first one is an error.
+    Buffer<float> smaller(W, H - 1);
+    output_ptrs[batch_size - 1] = smaller.raw_buffer();
+    errors = 0;
+    result = batch_batch(batch_size, input_ptrs.data(), offset, output_ptrs.data());
+    if (result == 0 || errors == 0) {
+        printf("Expected an error for an image with the wrong shape\n");
+        return -1;
+    }
+
+    // So is one with the wrong type.
+    Buffer<int> wrong_type(W, H);
+    output_ptrs[batch_size - 1] = wrong_type.raw_buffer();
+    errors = 0;
+    result = batch_batch(batch_size, input_ptrs.data(), offset, output_ptrs.data());
+    if (result == 0 || errors == 0) {
+        printf("Expected an error for an image with the wrong type\n");
+        return -1;
+    }
+
+    // So is one with no host memory.
+    halide_buffer_t no_host = *outputs[batch_size - 1].raw_buffer();
+    no_host.host = nullptr;
+    output_ptrs[batch_size - 1] = &no_host;
+    errors = 0;
+    result = batch_batch(batch_size, input_ptrs.data(), offset, output_ptrs.data());
+    if (result != halide_error_code_host_is_null || errors == 0) {
+        printf("Expected an error for an image with no host memory\n");
+        return -1;
+    }
+
+    // And so is one that is dirty on a device, which this pipeline
+    // can't copy back from.
+    halide_buffer_t device_dirty = *inputs[batch_size - 1].raw_buffer();
+    device_dirty.set_device_dirty(true);
+    input_ptrs[batch_size - 1] = &device_dirty;
+    output_ptrs[batch_size - 1] = outputs[batch_size - 1].raw_buffer();
+    errors = 0;
+    result = batch_batch(batch_size, input_ptrs.data(), offset, output_ptrs.data());
+    if (result != halide_error_code_device_dirty_with_no_device_support || errors == 0) {
+        printf("Expected an error for an image that is dirty on a device\n");
+        return -1;
+    }
+    input_ptrs[batch_size - 1] = inputs[batch_size - 1].raw_buffer();
+
+    // So is one that isn't as aligned as the generator requires.
+    halide_buffer_t misaligned = *inputs[batch_size - 1].raw_buffer();
+    misaligned.host += sizeof(float);
+    input_ptrs[batch_size - 1] = &misaligned;
+    errors = 0;
+    result = batch_batch(batch_size, input_ptrs.data(), offset, output_ptrs.data());
+    if (result != halide_error_code_unaligned_host_ptr || errors == 0) {
+        printf("Expected an error for an image that isn't aligned\n");
+        return -1;
+    }
+    input_ptrs[batch_size - 1] = inputs[batch_size - 1].raw_buffer();
+
+    // A bounds query on the first image is answered, and nothing runs.
+    halide_buffer_t query = *inputs[0].raw_buffer();
+    halide_dimension_t query_dims[2];
+    memcpy(query_dims, query.dim, sizeof(query_dims));
+    query.dim = query_dims;
+    query.host = nullptr;
+    halide_buffer_t *query_ptr = &query;
+    output_ptrs[0] = outputs[0].raw_buffer();
+    result = batch_batch(1, &query_ptr, offset, output_ptrs.data());
+    if (result != 0 || query.dim[0].extent != W + 1 || query.dim[1].extent != H + 1) {
+        printf("Bounds query failed\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -0,0 +1,28 @@
+#include "Halide.h"
+
+namespace {
+
+class Batch : public Halide::Generator<Batch> {
+public:
+    Input<Buffer<float>>  input{"input", 2};
+    Input<float>          offset{"offset"};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        // Each image in the batch must meet this, not just the first.
+        input.set_host_alignment(16);
+
+        Var x, y;
+
+        Func f;
+        f(x, y) = input(x, y) * 2;
+        f.compute_root();
+
+        output(x, y) = f(x, y) + f(x + 1, y + 1) + offset;
+        output.parallel(y);
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(Batch, batch)
@@ -0,0 +1,113 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "HalideRuntime.h"
+#include "HalideBuffer.h"
+#include "pipeline_instance.instance.h"
+
+using namespace Halide::Runtime;
+
+static int other_mallocs = 0;
+
+void *my_halide_malloc(void *context, size_t sz) {
+    other_mallocs++;
+    return malloc(sz);
+}
+
+void my_halide_free(void *context, void *ptr) {
+    free(ptr);
+}
+
+bool run_and_check(pipeline_instance_instance_t *instance, int w, int h) {
+    Buffer<float> input(w + 1, h + 1);
+    input.for_each_element([&](int x, int y) {
+        input(x, y) = (float)(x + y * 10);
+    });
+    Buffer<float> output(w, h);
+
+    int result = pipeline_instance_instance_run(instance, input, 1.0f, output);
+    if (result != 0) {
+        printf("Pipeline failed with error %d\n", result);
+        return false;
+    }
+
+    bool ok = true;
+    output.for_each_element([&](int x, int y) {
+        float g0 = 2 * (input(x, y) + input(x + 1, y)) + 1.0f;
+        float g1 = 2 * (input(x, y + 1) + input(x + 1, y + 1)) + 1.0f;
+        if (ok && output(x, y) != g0 + g1) {
+            printf("output(%d, %d) = %f instead of %f\n", x, y, output(x, y), g0 + g1);
+            ok = false;
+        }
+    });
+    return ok;
+}
+
+int main(int argc, char **argv) {
+    halide_set_custom_malloc(&my_halide_malloc);
+    halide_set_custom_free(&my_halide_free);
+
+    pipeline_instance_instance_t *instance = pipeline_instance_instance_create();
+
+    if (!run_and_check(instance, 100, 80)) {
+        return -1;
+    }
+    uint64_t allocations = instance->total_allocations();
+    size_t scratch = instance->scratch_bytes();
+    if (allocations == 0 || scratch == 0) {
+        printf("The instance didn't hold on to the intermediates\n");
+        return -1;
+    }
+    // The instance allocates its blocks with the malloc that was
+    // installed before it was created.
+    if (other_mallocs < (int)allocations) {
+        printf("%d calls to the old malloc for %d allocations\n", other_mallocs, (int)allocations);
+        return -1;
+    }
+
+    // Running again with the same shapes shouldn't allocate anything.
+    for (int i = 0; i < 5; i++) {
+        if (!run_and_check(instance, 100, 80)) {
+            return -1;
+        }
+    }
+    if (instance->total_allocations() != allocations ||
+        instance->scratch_bytes() != scratch) {
+        printf("Repeated runs allocated scratch memory\n");
+        return -1;
+    }
+
+    // Changing the shapes reallocates, and releases the old blocks.
+    if (!run_and_check(instance, 200, 40)) {
+        return -1;
+    }
+    if (instance->total_allocations() <= allocations) {
+        printf("A run with new shapes didn't allocate\n");
+        return -1;
+    }
+    size_t new_scratch = instance->scratch_bytes();
+    if (new_scratch == scratch) {
+        printf("A run with new shapes didn't change the scratch memory\n");
+        return -1;
+    }
+    allocations = instance->total_allocations();
+    if (!run_and_check(instance, 200, 40) ||
+        instance->total_allocations() != allocations) {
+        printf("Repeated runs with new shapes allocated scratch memory\n");
+        return -1;
+    }
+
+    pipeline_instance_instance_destroy(instance);
+
+    // Once the instance is gone, its malloc handler should be too.
+    other_mallocs = 0;
+    void *p = halide_malloc(nullptr, 16);
+    halide_free(nullptr, p);
+    if (other_mallocs != 1) {
+        printf("The old malloc handler wasn't restored\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
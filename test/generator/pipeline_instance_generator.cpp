@@ -0,0 +1,33 @@
+#include "Halide.h"
+
+namespace {
+
+class PipelineInstance : public Halide::Generator<PipelineInstance> {
+public:
+    Input<Buffer<float>>  input{"input", 2};
+    Input<float>          offset{"offset"};
+    Output<Buffer<float>> output{"output", 2};
+
+    void generate() {
+        Var x, y;
+
+        // Two intermediates with sizes that depend on the output size,
+        // so that both are allocated with halide_malloc.
+        Func f, g;
+        f(x, y) = input(x, y) * 2;
+        g(x, y) = f(x, y) + f(x + 1, y) + offset;
+        f.compute_root();
+        g.compute_root();
+
+        output(x, y) = g(x, y) + g(x, y + 1);
+        output.parallel(y);
+
+        // The profiler calls halide_malloc with a nullptr user_context,
+        // which would bypass the instance.
+        assert(!get_target().has_feature(Target::Profile));
+    }
+};
+
+}  // namespace
+
+HALIDE_REGISTER_GENERATOR(PipelineInstance, pipeline_instance)
@@ -0,0 +1,93 @@
+#include "Halide.h"
+#include <cstdio>
+#include <cstdlib>
+#include "halide_benchmark.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+void set_auto_schedule_prefetch(bool enable) {
+#ifdef _WIN32
+    _putenv_s("HL_AUTO_SCHEDULE_PREFETCH", enable ? "1" : "0");
+#else
+    setenv("HL_AUTO_SCHEDULE_PREFETCH", enable ? "1" : "0", 1);
+#endif
+}
+
+// A separable 3x3 blur, which streams through its input once.
+Func blur(ImageParam input, Func &blur_x) {
+    Var x("x"), y("y");
+    Func blur_y("blur_y");
+    blur_x = Func("blur_x");
+    blur_x(x, y) = (input(x, y) + input(x + 1, y) + input(x + 2, y)) / 3;
+    blur_y(x, y) = (blur_x(x, y) + blur_x(x, y + 1) + blur_x(x, y + 2)) / 3;
+    return blur_y;
+}
+
+int main(int argc, char **argv) {
+    const int W = 6400, H = 4800;
+
+    Buffer<uint16_t> in(W + 2, H + 2);
+    for (int y = 0; y < in.height(); y++) {
+        for (int x = 0; x < in.width(); x++) {
+            in(x, y) = rand() & 0xfff;
+        }
+    }
+
+    Target target = get_jit_target_from_environment();
+    const char *names[] = {"auto-scheduled", "auto-scheduled with prefetch", "hand-tuned prefetch"};
+    double times[3];
+    Buffer<uint16_t> outputs[3] = {Buffer<uint16_t>(W, H), Buffer<uint16_t>(W, H), Buffer<uint16_t>(W, H)};
+    for (int i = 0; i < 3; i++) {
+        ImageParam input(UInt(16), 2, "input");
+        Func blur_x;
+        Func f = blur(input, blur_x);
+        Pipeline p(f);
+        if (i < 2) {
+            f.estimate(f.args()[0], 0, W).estimate(f.args()[1], 0, H);
+            set_auto_schedule_prefetch(i == 1);
+            std::string schedule = p.auto_schedule(target);
+            if ((i == 1) && (schedule.find("prefetch(input") == std::string::npos)) {
+                printf("Expected the auto-scheduler to prefetch the input:\n%s\n",
+                       schedule.c_str());
+                return -1;
+            }
+        } else {
+            // The schedule of the apps that prefetch their input by hand.
+            Var x = f.args()[0], y = f.args()[1], yo("yo"), yi("yi");
+            const int vec = target.natural_vector_size<uint16_t>();
+            f.compute_root().split(y, yo, yi, 32).parallel(yo)
+                .vectorize(x, vec)
+                .prefetch(input, yi, 2);
+            blur_x.compute_at(f, yi).store_at(f, yo).vectorize(x, vec);
+        }
+        input.set(in);
+        p.compile_jit(target);
+        p.realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() { p.realize(outputs[i]); });
+        report_benchmark(std::string("auto_prefetch/") + names[i], stats);
+        times[i] = stats.min;
+    }
+    set_auto_schedule_prefetch(false);
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            for (int i = 1; i < 3; i++) {
+                if (outputs[i](x, y) != outputs[0](x, y)) {
+                    printf("%s output differs at %d %d: %d instead of %d\n",
+                           names[i], x, y, outputs[i](x, y), outputs[0](x, y));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // Prefetching should never make the auto-scheduled pipeline much slower.
+    if (times[1] > times[0] * 1.5) {
+        printf("Prefetching slowed down the auto-scheduled pipeline\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
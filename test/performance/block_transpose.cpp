@@ -54,9 +54,11 @@ Buffer<uint16_t> test_transpose(int mode) {
 
     output.realize(result);
 
-    double t = benchmark([&]() {
+    BenchmarkStatistics stats = benchmark_statistics([&]() {
         output.realize(result);
     });
+    report_benchmark("block_transpose/dummy_func/" + algorithm, stats);
+    double t = stats.min;
 
     std::cout << "Dummy Func version: "  << algorithm << " bandwidth " << 1024*1024 / t << " byte/s.\n";
     return result;
@@ -104,9 +106,11 @@ Buffer<uint16_t> test_transpose_wrap(int mode) {
 
     output.realize(result);
 
-    double t = benchmark([&]() {
+    BenchmarkStatistics stats = benchmark_statistics([&]() {
         output.realize(result);
     });
+    report_benchmark("block_transpose/wrapper/" + algorithm, stats);
+    double t = stats.min;
 
     std::cout << "Wrapper version: "  << algorithm << " bandwidth " << 1024*1024 / t << " byte/s.\n";
     return result;
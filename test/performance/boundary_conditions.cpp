@@ -30,12 +30,12 @@ struct Test {
 
         Buffer<float> out = g.realize(W, H);
 
-        time = benchmark([&]() {
+        BenchmarkStatistics stats = benchmark_statistics([&]() {
                 g.realize(out);
                 out.device_sync();
         });
-
-        printf("%-20s: %f us\n", name, time * 1e6);
+        report_benchmark(std::string("boundary_conditions/small_stencil/") + name, stats);
+        time = stats.min;
     }
 
     // Test a larger stencil using an RDom
@@ -55,12 +55,12 @@ struct Test {
 
         Buffer<float> out = g.realize(W, H);
 
-        time = benchmark([&]() {
+        BenchmarkStatistics stats = benchmark_statistics([&]() {
                 g.realize(out);
                 out.device_sync();
         });
-
-        printf("%-20s: %f us\n", name, time * 1e6);
+        report_benchmark(std::string("boundary_conditions/rdom_stencil/") + name, stats);
+        time = stats.min;
     }
 };
 
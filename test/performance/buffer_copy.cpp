@@ -0,0 +1,116 @@
+#include "Halide.h"
+#include <cstdio>
+#include "halide_benchmark.h"
+
+using namespace Halide::Runtime;
+using namespace Halide::Tools;
+
+// Compare Buffer::copy_from and Buffer::fill against the element-wise
+// copy and fill they used to be, which walk every value with
+// for_each_value.
+
+template<typename T>
+void reference_copy(Buffer<T> &dst, const Buffer<T> &src) {
+    dst.for_each_value([](T &d, T s) { d = s; }, src);
+}
+
+template<typename T>
+bool test_copy(const char *name, Buffer<T> dst, Buffer<T> src, int threads = 1) {
+    src.for_each_element([&](int x, int y, int c) {
+        src(x, y, c) = (T)(x * 3 + y * 5 + c);
+    });
+
+    BenchmarkStatistics t_ref = benchmark_statistics([&]() { reference_copy(dst, src); });
+    BenchmarkStatistics t_new = benchmark_statistics([&]() { dst.copy_from(src, threads); });
+
+    // The reference copy already filled dst, so clear it and copy once
+    // more before checking.
+    dst.for_each_value([](T &v) { v = 0; });
+    dst.copy_from(src, threads);
+
+    bool ok = true;
+    dst.for_each_element([&](int x, int y, int c) {
+        if (ok && dst(x, y, c) != src(x, y, c)) {
+            printf("%s: dst(%d, %d, %d) = %d instead of %d\n",
+                   name, x, y, c, (int)dst(x, y, c), (int)src(x, y, c));
+            ok = false;
+        }
+    });
+    if (!ok) {
+        return false;
+    }
+
+    report_benchmark(std::string("buffer_copy/") + name + "/for_each_value", t_ref);
+    report_benchmark(std::string("buffer_copy/") + name + "/copy_from", t_new);
+    if (t_new.min > t_ref.min * 1.2) {
+        printf("copy_from is slower than an element-wise copy\n");
+        return false;
+    }
+    return true;
+}
+
+template<typename T>
+bool test_fill(const char *name, Buffer<T> buf, T val, int threads = 1) {
+    BenchmarkStatistics t_ref = benchmark_statistics([&]() { buf.for_each_value([=](T &v) { v = val; }); });
+    buf.for_each_value([](T &v) { v = 1; });
+    BenchmarkStatistics t_new = benchmark_statistics([&]() { buf.fill(val, threads); });
+
+    bool ok = true;
+    buf.for_each_value([&](T v) { ok = ok && v == val; });
+    if (!ok) {
+        printf("%s: fill didn't set every value\n", name);
+        return false;
+    }
+
+    report_benchmark(std::string("buffer_copy/") + name + "/for_each_value", t_ref);
+    report_benchmark(std::string("buffer_copy/") + name + "/fill", t_new);
+    if (t_new.min > t_ref.min * 1.2) {
+        printf("fill is slower than an element-wise fill\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    const int W = 1920, H = 1080;
+
+    // Dense buffers of the same shape collapse into one memcpy.
+    if (!test_copy("dense", Buffer<uint8_t>(W, H, 3), Buffer<uint8_t>(W, H, 3))) {
+        return -1;
+    }
+
+    // Copying out of a crop copies a row at a time.
+    {
+        Buffer<uint16_t> src(W + 64, H + 64, 3);
+        src.crop(0, 32, W);
+        src.crop(1, 32, H);
+        src.set_min(0, 0, 0);
+        if (!test_copy("cropped", Buffer<uint16_t>(W, H, 3), src)) {
+            return -1;
+        }
+    }
+
+    // Converting between interleaved and planar layouts.
+    if (!test_copy("planar to interleaved",
+                   Buffer<uint8_t>::make_interleaved(W, H, 3), Buffer<uint8_t>(W, H, 3)) ||
+        !test_copy("interleaved to planar",
+                   Buffer<uint8_t>(W, H, 4), Buffer<uint8_t>::make_interleaved(W, H, 4)) ||
+        !test_copy("interleaved to planar (float)",
+                   Buffer<float>(W, H, 3), Buffer<float>::make_interleaved(W, H, 3))) {
+        return -1;
+    }
+
+    // A large copy split across threads.
+    if (!test_copy("multi-threaded", Buffer<float>(4 * W, H, 3), Buffer<float>(4 * W, H, 3), 8)) {
+        return -1;
+    }
+
+    if (!test_fill("fill with zero", Buffer<float>(W, H, 3), 0.0f) ||
+        !test_fill("fill", Buffer<uint16_t>(W, H, 3), (uint16_t)1234) ||
+        !test_fill("multi-threaded fill", Buffer<float>(4 * W, H, 3), 0.5f, 8)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
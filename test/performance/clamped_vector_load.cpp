@@ -12,7 +12,7 @@ Buffer<uint16_t> output;
 #define MIN 1
 #define MAX 1020
 
-double test(Func f, bool test_correctness = true) {
+double test(const char *name, Func f, bool test_correctness = true) {
     f.compile_to_assembly(f.name() + ".s", {input}, f.name());
     f.compile_jit();
     f.realize(output);
@@ -32,7 +32,9 @@ double test(Func f, bool test_correctness = true) {
         }
     }
 
-    return benchmark([&]() { f.realize(output); });
+    BenchmarkStatistics stats = benchmark_statistics([&]() { f.realize(output); });
+    report_benchmark(std::string("clamped_vector_load/") + name, stats);
+    return stats.min;
 }
 
 int main(int argc, char **argv) {
@@ -60,7 +62,7 @@ int main(int argc, char **argv) {
 
         f.vectorize(x, 8);
 
-        t_ref = test(f, false);
+        t_ref = test("unclamped", f, false);
     }
 
     {
@@ -74,7 +76,7 @@ int main(int argc, char **argv) {
         f.vectorize(x, 8);
         f.compile_to_lowered_stmt("debug_clamped_vector_load.stmt", f.infer_arguments());
 
-        t_clamped = test(f);
+        t_clamped = test("clamped", f);
     }
 
     {
@@ -88,7 +90,7 @@ int main(int argc, char **argv) {
         f.vectorize(x, 8);
         g.compute_at(f, x);
 
-        t_scalar = test(f);
+        t_scalar = test("scalarized", f);
     }
 
     {
@@ -102,7 +104,7 @@ int main(int argc, char **argv) {
         f.vectorize(x, 8);
         g.compute_at(f, y);
 
-        t_pad = test(f);
+        t_pad = test("padded", f);
     }
 
     // This constraint is pretty lax, because the op is so trivial
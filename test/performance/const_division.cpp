@@ -1,6 +1,7 @@
 #include "Halide.h"
 #include <cstdio>
 #include <cstdint>
+#include <string>
 #include "halide_benchmark.h"
 
 using namespace Halide;
@@ -14,10 +15,6 @@ bool test(int w, bool div) {
     size_t bits = sizeof(T)*8;
     bool is_signed = (T)(-1) < (T)(0);
 
-    printf("%sInt(%2d, %2d)    ",
-           is_signed ? " " : "U",
-           (int)bits, w);
-
     int min_val = 2, num_vals = 254;
 
     if (bits <= 8 && is_signed) {
@@ -71,15 +68,24 @@ bool test(int w, bool div) {
     h.compile_jit();
 
     Buffer<T> correct = g.realize(input.width(), num_vals);
-    double t_correct = benchmark([&]() { g.realize(correct); });
+    BenchmarkStatistics s_correct = benchmark_statistics([&]() { g.realize(correct); });
 
     Buffer<T> fast = f.realize(input.width(), num_vals);
-    double t_fast = benchmark([&]() { f.realize(fast); });
+    BenchmarkStatistics s_fast = benchmark_statistics([&]() { f.realize(fast); });
 
     Buffer<T> fast_dynamic = h.realize(input.width(), num_vals);
-    double t_fast_dynamic = benchmark([&]() { h.realize(fast_dynamic); });
-
-    printf("%6.3f                  %6.3f\n", t_correct / t_fast, t_correct / t_fast_dynamic);
+    BenchmarkStatistics s_fast_dynamic = benchmark_statistics([&]() { h.realize(fast_dynamic); });
+
+    std::string name = std::string("const_division/") + (div ? "div/" : "mod/") +
+        (is_signed ? "int" : "uint") + std::to_string(bits) + "x" + std::to_string(w);
+    report_benchmark(name + "/reference", s_correct);
+    report_benchmark(name + "/const", s_fast);
+    report_benchmark(name + "/runtime", s_fast_dynamic);
+
+    double t_correct = s_correct.min, t_fast = s_fast.min, t_fast_dynamic = s_fast_dynamic.min;
+    printf("%sInt(%2d, %2d)    %6.3f                  %6.3f\n",
+           is_signed ? " " : "U", (int)bits, w,
+           t_correct / t_fast, t_correct / t_fast_dynamic);
 
     for (int y = 0; y < num_vals; y++) {
         for (int x = 0; x < input.width(); x++) {
@@ -0,0 +1,140 @@
+#include "Halide.h"
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "halide_benchmark.h"
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+int main(int argc, char **argv) {
+    Target host = get_jit_target_from_environment();
+    if (host.arch != Target::X86) {
+        printf("Skipping test: cpu_dispatch is only implemented on x86\n");
+        return 0;
+    }
+
+    // The baseline x86 target, without any of the host's instruction
+    // set extensions.
+    Target base = host;
+    for (Target::Feature f : {Target::SSE41, Target::AVX, Target::AVX2, Target::FMA,
+                              Target::FMA4, Target::F16C, Target::AVX512,
+                              Target::AVX512_KNL, Target::AVX512_Skylake,
+                              Target::AVX512_Cannonlake, Target::AVX512_VNNI}) {
+        base = base.without_feature(f);
+    }
+    Target dispatch = base.with_feature(Target::CPUDispatch);
+
+    // Something compute bound that fits in cache, so that the
+    // instruction set matters.
+    const int W = 1024, H = 64;
+    Buffer<float> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (float)(rand() % 1024) / 1024.0f;
+        }
+    }
+
+    // The dispatched loop nest may contain parallel tasks, which are
+    // separate functions that must be compiled for the same target as
+    // the version that launches them.
+    const char *names[] = {"base target", "base target with cpu_dispatch", "host target",
+                           "parallel base target with cpu_dispatch", "parallel host target"};
+    Target targets[] = {base, dispatch, host, dispatch, host};
+    bool parallel[] = {false, false, false, true, true};
+    const int num_tests = 5;
+    double times[num_tests];
+    std::vector<Buffer<float>> outputs;
+    for (int i = 0; i < num_tests; i++) {
+        outputs.emplace_back(W, H);
+    }
+    for (int i = 0; i < num_tests; i++) {
+        Var x, y;
+        Func f;
+        Expr v = input(x, y);
+        Expr e = v;
+        for (int j = 0; j < 16; j++) {
+            e = e * v + (float)j;
+        }
+        f(x, y) = e;
+        f.vectorize(x, 16);
+        if (parallel[i]) {
+            f.parallel(y);
+        }
+
+        if (targets[i].has_feature(Target::CPUDispatch)) {
+            // The loop should also have been compiled for AVX2 and
+            // AVX-512, which use ymm and zmm registers.
+            std::string asm_filename = Internal::get_test_tmp_dir() + "halide_cpu_dispatch_" +
+                std::to_string(i) + ".s";
+            f.compile_to_assembly(asm_filename, {}, "halide_cpu_dispatch", targets[i]);
+            std::ifstream asm_file(asm_filename);
+            std::stringstream asm_text;
+            asm_text << asm_file.rdbuf();
+            if (asm_text.str().find("%ymm") == std::string::npos ||
+                asm_text.str().find("%zmm") == std::string::npos) {
+                printf("Expected AVX2 and AVX-512 versions of the loop in %s\n", asm_filename.c_str());
+                return -1;
+            }
+        }
+
+        if (i == 1) {
+            // Each version is a copy of the whole loop nest, so the
+            // code for it should grow by about the number of versions
+            // (the base target, SSE4.1, AVX2 and AVX-512), and not
+            // much more.
+            std::string base_obj = Internal::get_test_tmp_dir() + "halide_cpu_dispatch_base.o";
+            std::string dispatch_obj = Internal::get_test_tmp_dir() + "halide_cpu_dispatch.o";
+            f.compile_to_object(base_obj, {}, "halide_cpu_dispatch", base);
+            f.compile_to_object(dispatch_obj, {}, "halide_cpu_dispatch", dispatch);
+            std::ifstream base_file(base_obj, std::ios::binary | std::ios::ate);
+            std::ifstream dispatch_file(dispatch_obj, std::ios::binary | std::ios::ate);
+            long base_size = (long)base_file.tellg(), dispatch_size = (long)dispatch_file.tellg();
+            printf("Object size: %ld bytes without cpu_dispatch, %ld bytes with it\n",
+                   base_size, dispatch_size);
+            if (base_size <= 0 || dispatch_size > base_size * 5) {
+                printf("cpu_dispatch grew the code by more than the number of versions\n");
+                return -1;
+            }
+        }
+
+        f.compile_jit(targets[i]);
+        f.realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() { f.realize(outputs[i]); });
+        report_benchmark(std::string("cpu_dispatch/") + names[i], stats);
+        times[i] = stats.min;
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            for (int i = 1; i < num_tests; i++) {
+                // FMA changes the rounding.
+                if (std::abs(outputs[i](x, y) - outputs[0](x, y)) > 1e-3f * std::abs(outputs[0](x, y))) {
+                    printf("%s output differs at %d %d: %f instead of %f\n",
+                           names[i], x, y, outputs[i](x, y), outputs[0](x, y));
+                    return -1;
+                }
+            }
+        }
+    }
+
+    // The dispatched version should run the loop compiled for the
+    // best instruction set the host has, so it should be about as
+    // fast as compiling for the host directly, with or without
+    // parallel tasks.
+    if (times[1] > times[2] * 1.25) {
+        printf("cpu_dispatch is much slower than compiling for the host target\n");
+        return -1;
+    }
+    if (times[3] > times[4] * 1.25) {
+        printf("cpu_dispatch of a parallel loop is much slower than compiling for the host target\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
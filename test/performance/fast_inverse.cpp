@@ -27,8 +27,12 @@ int main(int argc, char **argv) {
 
     Buffer<float> out_fast(8), out_slow(8);
 
-    double slow_time = benchmark([&]() { slow.realize(out_slow); });
-    double fast_time = benchmark([&]() { fast.realize(out_fast); });
+    BenchmarkStatistics slow_stats = benchmark_statistics([&]() { slow.realize(out_slow); });
+    BenchmarkStatistics fast_stats = benchmark_statistics([&]() { fast.realize(out_fast); });
+    report_benchmark("fast_inverse/true", slow_stats);
+    report_benchmark("fast_inverse/fast", fast_stats);
+
+    double slow_time = slow_stats.min, fast_time = fast_stats.min;
 
     slow_time *= 1e9 / (out_fast.width() * N);
     fast_time *= 1e9 / (out_fast.width() * N);
@@ -47,9 +47,15 @@ int main(int argc, char **argv) {
     // All profiling runs are done into the same buffer, to avoid
     // cache weirdness.
     Buffer<float> timing_scratch(256, 256);
-    double t1 = 1e3 * benchmark([&]() { f.realize(timing_scratch); });
-    double t2 = 1e3 * benchmark([&]() { g.realize(timing_scratch); });
-    double t3 = 1e3 * benchmark([&]() { h.realize(timing_scratch); });
+    BenchmarkStatistics s1 = benchmark_statistics([&]() { f.realize(timing_scratch); });
+    BenchmarkStatistics s2 = benchmark_statistics([&]() { g.realize(timing_scratch); });
+    BenchmarkStatistics s3 = benchmark_statistics([&]() { h.realize(timing_scratch); });
+    report_benchmark("fast_pow/powf", s1);
+    report_benchmark("fast_pow/pow", s2);
+    report_benchmark("fast_pow/fast_pow", s3);
+    double t1 = 1e3 * s1.min;
+    double t2 = 1e3 * s2.min;
+    double t3 = 1e3 * s3.min;
 
     RDom r(correct_result);
     Func fast_error, faster_error;
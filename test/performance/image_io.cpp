@@ -0,0 +1,58 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include "halide_image_io.h"
+#include "test/common/halide_test_dirs.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Compare loading and saving uncompressed .tiff files, which read and
+// write the payload directly, against the .png path, which converts
+// each pixel (or the .ppm path, if we have no libpng).
+
+int main(int argc, char **argv) {
+    Buffer<uint16_t> im(2048, 2048, 3);
+    im.for_each_value([](uint16_t &v) { v = rand(); });
+
+#ifndef HALIDE_NO_PNG
+    const std::string other = "png";
+#else
+    const std::string other = "ppm";
+#endif
+
+    // Each load or save takes long enough to time on its own, so only
+    // take a few samples of one iteration each.
+    BenchmarkConfig config;
+    config.min_samples = 3;
+    config.max_iters = 10;
+
+    double load_time[2];
+    const std::string formats[] = {"tiff", other};
+    for (int i = 0; i < 2; i++) {
+        std::string filename = Halide::Internal::get_test_tmp_dir() + "perf_image_io." + formats[i];
+        BenchmarkStatistics save_stats = benchmark_statistics([&]() { save_image(im, filename); }, config);
+        Buffer<uint16_t> reloaded;
+        BenchmarkStatistics load_stats = benchmark_statistics([&]() { reloaded = load_image(filename); }, config);
+        report_benchmark("image_io/" + formats[i] + "/save", save_stats);
+        report_benchmark("image_io/" + formats[i] + "/load", load_stats);
+        load_time[i] = load_stats.min;
+
+        bool same = true;
+        im.for_each_element([&](int x, int y, int c) {
+            same = same && im(x, y, c) == reloaded(x, y, c);
+        });
+        if (!same) {
+            printf("Image saved as %s did not load back the same\n", formats[i].c_str());
+            return -1;
+        }
+    }
+
+    if (load_time[0] > load_time[1]) {
+        printf("Loading .tiff files is slower than loading .%s files\n", other.c_str());
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
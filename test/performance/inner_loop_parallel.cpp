@@ -27,9 +27,10 @@ int main(int argc, char **argv) {
         // Start the thread pool without giving any hints as to the
         // number of tasks we'll be using.
         f.realize(t, 1);
-        double min_time = benchmark([&]() { return f.realize(2, 1000000); });
+        BenchmarkStatistics stats = benchmark_statistics([&]() { return f.realize(2, 1000000); });
+        report_benchmark("inner_loop_parallel/threads_" + std::to_string(t), stats);
+        double min_time = stats.min;
 
-        printf("%d: %f ms\n", t, min_time * 1e3);
         if (t == 2) {
             correct_time = min_time;
         } else if (min_time > correct_time * 5) {
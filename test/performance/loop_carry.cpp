@@ -0,0 +1,65 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch != Target::X86 && target.arch != Target::ARM) {
+        printf("Skipping test because the loop_carry feature only applies to x86 and ARM.\n");
+        return 0;
+    }
+
+    const int W = 1024, H = 2048;
+
+    Buffer<float> input(W, H + 4);
+    input.for_each_element([&](int x, int y) {
+        input(x, y) = (float)((x * 17 + y * 13) % 64);
+    });
+
+    // A vertical stencil that sweeps down columns a vector wide, so
+    // that each iteration of the innermost (serial) y loop loads four
+    // of the five rows loaded by the previous one.
+    double times[2];
+    Buffer<float> outputs[2] = {Buffer<float>(W, H), Buffer<float>(W, H)};
+    for (int i = 0; i < 2; i++) {
+        ImageParam src(Float(32), 2);
+        Func blur;
+        Var x, y, xo, xi;
+        blur(x, y) = (src(x, y) + src(x, y + 1) * 4 + src(x, y + 2) * 6 +
+                      src(x, y + 3) * 4 + src(x, y + 4)) / 16;
+
+        const int vec = target.natural_vector_size<float>();
+        blur.split(x, xo, xi, vec).reorder(xi, y, xo).vectorize(xi).parallel(xo);
+
+        Target t = i == 0 ? target : target.with_feature(Target::LoopCarry);
+        src.set(input);
+        blur.compile_jit(t);
+        blur.realize(outputs[i]);
+
+        BenchmarkStatistics stats = benchmark_statistics([&]() {
+            blur.realize(outputs[i]);
+        });
+        report_benchmark(i == 0 ? "loop_carry/off" : "loop_carry/on", stats);
+        times[i] = stats.min;
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (outputs[1](x, y) != outputs[0](x, y)) {
+                printf("outputs[1](%d, %d) = %f instead of %f\n",
+                       x, y, outputs[1](x, y), outputs[0](x, y));
+                return -1;
+            }
+        }
+    }
+
+    printf("reloading: %f ms\n"
+           "carrying loads: %f ms (%.2fx)\n",
+           times[0] * 1e3, times[1] * 1e3, times[0] / times[1]);
+
+    printf("Success!\n");
+    return 0;
+}
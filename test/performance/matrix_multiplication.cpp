@@ -66,9 +66,11 @@ int main(int argc, char **argv) {
 
     matrix_mul.realize(output);
 
-    double t = benchmark([&]() {
+    BenchmarkStatistics stats = benchmark_statistics([&]() {
         matrix_mul.realize(output);
     });
+    report_benchmark("matrix_multiplication", stats);
+    double t = stats.min;
 
     // check results
     Buffer<float> output_ref(matrix_size, matrix_size);
@@ -24,19 +24,21 @@ int main(int argc, char **argv) {
 
     src.set(input);
 
-    double t1 = benchmark([&]() {
+    BenchmarkStatistics t1 = benchmark_statistics([&]() {
         dst.realize(output);
     });
+    report_benchmark("memcpy/halide", t1);
 
-    double t2 = benchmark([&]() {
+    BenchmarkStatistics t2 = benchmark_statistics([&]() {
         memcpy(output.data(), input.data(), input.width());
     });
+    report_benchmark("memcpy/system", t2);
 
     printf("system memcpy: %.3e byte/s\n", buffer_size / t2);
     printf("halide memcpy: %.3e byte/s\n", buffer_size / t1);
 
     // memcpy will win by a little bit for large inputs because it uses streaming stores
-    if (t1 > t2 * 3) {
+    if (t1.min > t2.min * 3) {
         printf("Halide memcpy is slower than it should be.\n");
         return -1;
     }
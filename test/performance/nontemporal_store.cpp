@@ -0,0 +1,89 @@
+#include "Halide.h"
+#include "halide_benchmark.h"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include "test/common/halide_test_dirs.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+
+    // A copy much larger than the last level cache, so that it is
+    // bound by memory bandwidth.
+    const int W = 4096, H = 8192;
+
+    Buffer<float> input(W, H);
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            input(x, y) = (float)(x + y);
+        }
+    }
+
+    double times[2];
+    Buffer<float> outputs[2] = {Buffer<float>(W, H), Buffer<float>(W, H)};
+    for (int i = 0; i < 2; i++) {
+        ImageParam src(Float(32), 2);
+        Func dst;
+        Var x, y;
+        dst(x, y) = src(x, y);
+
+        dst.vectorize(x, target.natural_vector_size<float>()).parallel(y, 16);
+        // Let the codegen prove the rows are aligned to a vector.
+        dst.output_buffer().set_host_alignment(64);
+        dst.output_buffer().dim(0).set_min(0);
+        dst.output_buffer().dim(1).set_min(0).set_stride(W);
+        if (i == 1) {
+            dst.store_nontemporal();
+
+            if (target.arch == Target::X86) {
+                std::string asm_filename = Internal::get_test_tmp_dir() + "halide_nontemporal_copy.s";
+                dst.compile_to_assembly(asm_filename, {src}, "halide_nontemporal_copy", target);
+                std::ifstream asm_file(asm_filename);
+                std::stringstream asm_text;
+                asm_text << asm_file.rdbuf();
+                if (asm_text.str().find("movnt") == std::string::npos) {
+                    printf("No non-temporal stores in %s\n", asm_filename.c_str());
+                    return -1;
+                }
+            }
+        }
+
+        src.set(input);
+        dst.compile_jit(target);
+        dst.realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() {
+            dst.realize(outputs[i]);
+        });
+        report_benchmark(i == 0 ? "nontemporal_store/regular" : "nontemporal_store/nontemporal", stats);
+        times[i] = stats.min;
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (outputs[1](x, y) != input(x, y)) {
+                printf("outputs[1](%d, %d) = %f instead of %f\n",
+                       x, y, outputs[1](x, y), input(x, y));
+                return -1;
+            }
+        }
+    }
+
+    const double bytes = 2.0 * W * H * sizeof(float);
+    printf("regular stores: %.3e byte/s\n", bytes / times[0]);
+    printf("non-temporal stores: %.3e byte/s\n", bytes / times[1]);
+
+    // Non-temporal stores skip reading the destination into the cache,
+    // so they should not be slower for a copy this large.
+    if ((target.arch == Target::X86 || target.arch == Target::ARM) &&
+        times[1] > times[0] * 1.2) {
+        printf("Non-temporal stores are slower than regular stores.\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
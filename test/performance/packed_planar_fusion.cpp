@@ -7,7 +7,7 @@
 using namespace Halide;
 using namespace Halide::Tools;
 
-double test_copy(Buffer<uint8_t> src, Buffer<uint8_t> dst) {
+double test_copy(const char *name, Buffer<uint8_t> src, Buffer<uint8_t> dst) {
     Var x, y, c;
     Func f;
     f(x, y, c) = src(x, y, c);
@@ -37,7 +37,9 @@ double test_copy(Buffer<uint8_t> src, Buffer<uint8_t> dst) {
 
     f.realize(dst);
 
-    return benchmark([&]() { return f.realize(dst); });
+    BenchmarkStatistics stats = benchmark_statistics([&]() { return f.realize(dst); });
+    report_benchmark(std::string("packed_planar_fusion/") + name, stats);
+    return stats.min;
 }
 
 Buffer<uint8_t> make_packed(uint8_t *host, int W, int H) {
@@ -60,13 +62,13 @@ int main(int argc, char **argv) {
     while ((size_t)ptr_1 & 0x1f) ptr_1 ++;
     while ((size_t)ptr_2 & 0x1f) ptr_2 ++;
 
-    double t_packed_packed = test_copy(make_packed(ptr_1, W, H),
+    double t_packed_packed = test_copy("packed_to_packed", make_packed(ptr_1, W, H),
                                        make_packed(ptr_2, W, H));
-    double t_packed_planar = test_copy(make_packed(ptr_1, W, H),
+    double t_packed_planar = test_copy("packed_to_planar", make_packed(ptr_1, W, H),
                                        make_planar(ptr_2, W, H));
-    double t_planar_packed = test_copy(make_planar(ptr_1, W, H),
+    double t_planar_packed = test_copy("planar_to_packed", make_planar(ptr_1, W, H),
                                        make_packed(ptr_2, W, H));
-    double t_planar_planar = test_copy(make_planar(ptr_1, W, H),
+    double t_planar_planar = test_copy("planar_to_planar", make_planar(ptr_1, W, H),
                                        make_planar(ptr_2, W, H));
 
 
@@ -0,0 +1,115 @@
+#include "Halide.h"
+#include <cstdio>
+#include "halide_benchmark.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Both tests read an intermediate with a power-of-two width down its
+// columns, once with dense rows, and once with the rows padded by
+// pad_storage.
+
+// Transpose a 2048x2048 intermediate in 8x8 blocks, as in
+// block_transpose.
+bool test_transpose() {
+    const int N = 2048;
+    Buffer<uint16_t> outputs[2] = {Buffer<uint16_t>(N, N), Buffer<uint16_t>(N, N)};
+    double times[2];
+    for (int i = 0; i < 2; i++) {
+        Func input, output;
+        Var x, y, xi, yi;
+        input(x, y) = cast<uint16_t>(x + 3 * y);
+        output(x, y) = input(y, x);
+
+        input.compute_root().vectorize(x, 8);
+        output.tile(x, y, xi, yi, 8, 8).vectorize(xi).unroll(yi);
+        input.in(output).compute_at(output, x).vectorize(x).unroll(y);
+        if (i == 1) {
+            input.pad_storage(x);
+        }
+
+        output.compile_jit();
+        output.realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() { output.realize(outputs[i]); });
+        report_benchmark(i == 0 ? "pad_storage/transpose/dense" : "pad_storage/transpose/padded", stats);
+        times[i] = stats.min;
+    }
+
+    for (int y = 0; y < N; y++) {
+        for (int x = 0; x < N; x++) {
+            uint16_t correct = (uint16_t)(y + 3 * x);
+            if (outputs[0](x, y) != correct || outputs[1](x, y) != correct) {
+                printf("transpose(%d, %d) = %d, %d instead of %d\n",
+                       x, y, outputs[0](x, y), outputs[1](x, y), correct);
+                return false;
+            }
+        }
+    }
+
+    if (times[1] > times[0] * 1.2) {
+        printf("Padding the storage made the transpose slower\n");
+        return false;
+    }
+    return true;
+}
+
+// A tall vertical stencil, tiled, over a 1024 float wide intermediate.
+bool test_stencil() {
+    const int W = 1024, H = 2048, taps = 16;
+    Buffer<float> input(W, H + taps);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = (float)(rand() & 0xff);
+        }
+    }
+
+    Buffer<float> outputs[2] = {Buffer<float>(W, H), Buffer<float>(W, H)};
+    double times[2];
+    for (int i = 0; i < 2; i++) {
+        Func in, out;
+        Var x, y, xi, yi;
+        in(x, y) = input(x, y) * 2.0f;
+        Expr sum = 0.0f;
+        for (int j = 0; j < taps; j++) {
+            sum += in(x, y + j);
+        }
+        out(x, y) = sum;
+
+        in.compute_root().vectorize(x, 8).parallel(y, 16);
+        out.tile(x, y, xi, yi, 32, 32).vectorize(xi, 8).parallel(y);
+        if (i == 1) {
+            in.pad_storage(x);
+        }
+
+        out.compile_jit();
+        out.realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() { out.realize(outputs[i]); });
+        report_benchmark(i == 0 ? "pad_storage/stencil/dense" : "pad_storage/stencil/padded", stats);
+        times[i] = stats.min;
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            if (outputs[0](x, y) != outputs[1](x, y)) {
+                printf("stencil(%d, %d) = %f with padding instead of %f\n",
+                       x, y, outputs[1](x, y), outputs[0](x, y));
+                return false;
+            }
+        }
+    }
+
+    if (times[1] > times[0] * 1.2) {
+        printf("Padding the storage made the stencil slower\n");
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    if (!test_transpose() || !test_stencil()) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
@@ -21,13 +21,15 @@ int main(int argc, char **argv) {
 
     Buffer<float> imf = f.realize(W, H);
 
-    double parallelTime = benchmark([&]() { f.realize(imf); });
+    BenchmarkStatistics parallelTime = benchmark_statistics([&]() { f.realize(imf); });
+    report_benchmark("parallel_performance/parallel", parallelTime);
 
     printf("Realizing g\n");
     Buffer<float> img = g.realize(W, H);
     printf("Done realizing g\n");
 
-    double serialTime = benchmark([&]() { g.realize(img); });
+    BenchmarkStatistics serialTime = benchmark_statistics([&]() { g.realize(img); });
+    report_benchmark("parallel_performance/serial", serialTime);
 
     for (int y = 0; y < H; y++) {
         for (int x = 0; x < W; x++) {
@@ -39,8 +41,8 @@ int main(int argc, char **argv) {
         }
     }
 
-    printf("Times: %f %f\n", serialTime, parallelTime);
-    double speedup = serialTime / parallelTime;
+    printf("Times: %f %f\n", serialTime.min, parallelTime.min);
+    double speedup = serialTime.min / parallelTime.min;
     printf("Speedup: %f\n", speedup);
 
     if (speedup < 1.5) {
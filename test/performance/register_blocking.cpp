@@ -0,0 +1,135 @@
+#include "Halide.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+#include "halide_benchmark.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+// Compare the auto-scheduler's register-blocked matrix multiply against
+// the hand-written schedule of the sgemm generator in apps/linear_algebra.
+// Matrices are column major, as in apps/linear_algebra.
+
+const int N = 1024;
+
+// The non-transposed case of GEMMGenerator in
+// apps/linear_algebra/src/blas_l3_generators.cpp, without the scaling
+// and accumulation into C.
+Func linear_algebra_sgemm(ImageParam A_in, ImageParam B_in, const Target &target) {
+    const int vec = target.natural_vector_size<float>();
+    const int s = vec * 2;
+
+    Var i, j, ii, ji, io, jo, t;
+    Var ti[2], tj[2];
+
+    // Swizzle A for better memory order in the inner loop.
+    Func A("A"), As("As"), Atmp("Atmp");
+    Atmp(i, j) = BoundaryConditions::constant_exterior(A_in, 0.0f)(i, j);
+    As(i, j, io) = Atmp(io*s + i, j);
+    A(i, j) = As(i % s, j, i / s);
+
+    Func AB("AB"), result("result");
+    RDom rv(0, N);
+    AB(i, j) += A(i, rv) * B_in(rv, j);
+    result(i, j) = AB(i, j);
+
+    result.tile(i, j, ti[1], tj[1], i, j, 2*s, 2*s, TailStrategy::GuardWithIf)
+        .tile(i, j, ii, ji, s, 4)
+        .tile(i, j, ti[0], tj[0], i, j, 1, s/4)
+        .fuse(tj[1], ti[1], t).parallel(t);
+    result.bound(i, 0, N).bound(j, 0, N);
+
+    As.compute_root()
+        .split(j, jo, ji, s).reorder(i, ji, io, jo)
+        .unroll(i).vectorize(ji).parallel(jo, 4);
+    Atmp.compute_at(As, io)
+        .vectorize(i).unroll(j);
+    AB.compute_at(result, i)
+        .bound_extent(j, 4).unroll(j)
+        .bound_extent(i, s).vectorize(i)
+        .update()
+        .reorder(i, j, rv).unroll(j).unroll(rv, 2).vectorize(i);
+
+    return result;
+}
+
+Func auto_scheduled_sgemm(ImageParam A, ImageParam B, const Target &target, std::string *schedule) {
+    Var i("i"), j("j");
+    Func result("result");
+    RDom k(0, N);
+    result(i, j) = 0.0f;
+    result(i, j) += A(i, k) * B(k, j);
+
+    A.dim(0).set_bounds_estimate(0, N).dim(1).set_bounds_estimate(0, N);
+    B.dim(0).set_bounds_estimate(0, N).dim(1).set_bounds_estimate(0, N);
+    result.estimate(i, 0, N).estimate(j, 0, N);
+    *schedule = Pipeline(result).auto_schedule(target);
+
+    return result;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment().with_feature(Target::AccumulateInRegisters);
+    if (target.has_gpu_feature()) {
+        printf("Skipping test: the register blocking only applies to CPU schedules\n");
+        return 0;
+    }
+
+    Buffer<float> mat_A(N, N), mat_B(N, N);
+    for (int y = 0; y < N; y++) {
+        for (int x = 0; x < N; x++) {
+            mat_A(x, y) = (rand() % 256) / 256.0f;
+            mat_B(x, y) = (rand() % 256) / 256.0f;
+        }
+    }
+
+    const char *names[] = {"apps/linear_algebra sgemm", "auto-scheduled"};
+    double times[2];
+    Buffer<float> outputs[2] = {Buffer<float>(N, N), Buffer<float>(N, N)};
+    for (int i = 0; i < 2; i++) {
+        ImageParam A(Float(32), 2), B(Float(32), 2);
+        std::string schedule;
+        Func f = (i == 0) ? linear_algebra_sgemm(A, B, target) : auto_scheduled_sgemm(A, B, target, &schedule);
+        // The panel of the ImageParam walked along k should be packed.
+        if (i == 1 && schedule.find(".in(") == std::string::npos) {
+            printf("The auto-scheduler didn't pack an operand:\n%s\n", schedule.c_str());
+            return -1;
+        }
+        A.set(mat_A);
+        B.set(mat_B);
+
+        f.compile_jit(target);
+        f.realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() { f.realize(outputs[i]); });
+        times[i] = stats.min;
+        const double gflops = 2.0 * N * N * N / times[i] / 1e9;
+        report_benchmark(i == 0 ? "register_blocking/linear_algebra" : "register_blocking/auto_scheduled",
+                         stats, {{"gflops", gflops}});
+        printf("%s: %1.3g GFLOP/s\n", names[i], gflops);
+    }
+
+    // Check a sample of the results against a dot product.
+    for (int n = 0; n < 4096; n++) {
+        int x = rand() % N, y = rand() % N;
+        double correct = 0;
+        for (int k = 0; k < N; k++) {
+            correct += (double)mat_A(x, k) * mat_B(k, y);
+        }
+        for (int i = 0; i < 2; i++) {
+            if (std::abs(outputs[i](x, y) - correct) > 1e-3 * correct) {
+                printf("%s result at %d %d: %f instead of %f\n",
+                       names[i], x, y, outputs[i](x, y), correct);
+                return -1;
+            }
+        }
+    }
+
+    if (times[1] > times[0] * 1.5) {
+        printf("The auto-scheduled matrix multiply is much slower than apps/linear_algebra\n");
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
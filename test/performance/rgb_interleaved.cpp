@@ -47,9 +47,11 @@ void test_deinterleave() {
     // Warm up caches, etc.
     dst.realize(dst_image);
 
-    double t1 = benchmark([&]() {
+    BenchmarkStatistics s1 = benchmark_statistics([&]() {
         dst.realize(dst_image);
     });
+    report_benchmark("rgb_interleaved/interleaved_to_planar", s1);
+    double t1 = s1.min;
 
     printf("Interleaved to planar bandwidth %.3e byte/s.\n",
            dst_image.number_of_elements() / t1);
@@ -65,9 +67,11 @@ void test_deinterleave() {
     dst_image.transpose(1, 2);
     dst_image.fill(0);
 
-    double t2 = benchmark([&]() {
+    BenchmarkStatistics s2 = benchmark_statistics([&]() {
         dst.realize(dst_image);
     });
+    report_benchmark("rgb_interleaved/interleaved_to_semi_planar", s2);
+    double t2 = s2.min;
 
     dst_image.for_each_element([&](int x, int y) {
             assert(dst_image(x, y, 0) == 0);
@@ -126,9 +130,12 @@ void test_interleave(bool fast) {
     // Warm up caches, etc.
     dst.realize(dst_image);
 
-    double t = benchmark([&]() {
+    BenchmarkStatistics stats = benchmark_statistics([&]() {
         dst.realize(dst_image);
     });
+    report_benchmark(fast ? "rgb_interleaved/planar_to_interleaved/fast" :
+                            "rgb_interleaved/planar_to_interleaved/slow", stats);
+    double t = stats.min;
 
     printf("Planar to interleaved bandwidth %.3e byte/s.\n",
            dst_image.number_of_elements() / t);
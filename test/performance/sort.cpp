@@ -157,7 +157,7 @@ int main(int argc, char **argv) {
     printf("Running...\n");
     Buffer<int> bitonic_sorted(N);
     f.realize(bitonic_sorted);
-    double t_bitonic = benchmark([&]() {
+    BenchmarkStatistics s_bitonic = benchmark_statistics([&]() {
         f.realize(bitonic_sorted);
     });
 
@@ -168,7 +168,7 @@ int main(int argc, char **argv) {
     printf("Running...\n");
     Buffer<int> merge_sorted(N);
     f.realize(merge_sorted);
-    double t_merge = benchmark([&]() {
+    BenchmarkStatistics s_merge = benchmark_statistics([&]() {
         f.realize(merge_sorted);
     });
 
@@ -177,15 +177,13 @@ int main(int argc, char **argv) {
         correct(i) = data(i);
     }
     printf("std::sort...\n");
-    double t_std = benchmark([&]() {
+    BenchmarkStatistics s_std = benchmark_statistics([&]() {
         std::sort(&correct(0), &correct(N));
     });
 
-    printf("Times:\n"
-           "bitonic sort: %fms \n"
-           "merge sort: %fms \n"
-           "std::sort %fms\n",
-           t_bitonic * 1e3, t_merge * 1e3, t_std * 1e3);
+    report_benchmark("sort/bitonic_sort", s_bitonic);
+    report_benchmark("sort/merge_sort", s_merge);
+    report_benchmark("sort/std_sort", s_std);
 
     if (N <= 100) {
         for (int i = 0; i < N; i++) {
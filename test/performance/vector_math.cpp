@@ -0,0 +1,181 @@
+#include "Halide.h"
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#include "halide_benchmark.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+enum Op {Sin, Cos, Exp, Log};
+const char *op_names[] = {"sin", "cos", "exp", "log"};
+
+Expr apply(Op op, Expr x) {
+    switch (op) {
+    case Sin: return sin(x);
+    case Cos: return cos(x);
+    case Exp: return exp(x);
+    default: return log(x);
+    }
+}
+
+long double reference(Op op, long double x) {
+    switch (op) {
+    case Sin: return sinl(x);
+    case Cos: return cosl(x);
+    case Exp: return expl(x);
+    default: return logl(x);
+    }
+}
+
+// The distance from a to the correctly rounded result, in units of the
+// last place of T.
+template<typename T>
+double ulps(T a, long double correct) {
+    T c = (T)correct;
+    if (std::isnan(c) || std::isinf(c)) {
+        return (a == c || (std::isnan(a) && std::isnan(c))) ? 0 : 1e9;
+    }
+    T ulp = std::nextafter(std::fabs(c), std::numeric_limits<T>::infinity()) - std::fabs(c);
+    return (double)(std::fabs(a - correct) / ulp);
+}
+
+// Compare a vectorized evaluation of a transcendental against a scalar
+// one, which calls libm for every element.
+template<typename T>
+bool test(const Target &target, Op op, T lo, T hi, double max_ulps) {
+    const int N = 1 << 20;
+    const int vec = target.natural_vector_size<T>();
+    Buffer<T> input(N);
+    for (int i = 0; i < N; i++) {
+        input(i) = lo + (hi - lo) * (T)i / (T)(N - 1);
+    }
+
+    const char *type_name = sizeof(T) == 4 ? "float" : "double";
+    const char *versions[] = {"scalar", "vectorized"};
+    Var x;
+    double times[2];
+    Buffer<T> outputs[2] = {Buffer<T>(N), Buffer<T>(N)};
+    for (int i = 0; i < 2; i++) {
+        Func f;
+        f(x) = apply(op, input(x));
+        if (i == 1) {
+            f.vectorize(x, vec);
+        }
+        f.compile_jit(target);
+        f.realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() { f.realize(outputs[i]); });
+        report_benchmark(std::string("vector_math/") + op_names[op] + "/" + type_name + "/" + versions[i], stats);
+        times[i] = stats.min;
+    }
+
+    double worst = 0;
+    T worst_x = 0;
+    for (int i = 0; i < N; i++) {
+        double e = ulps(outputs[1](i), reference(op, input(i)));
+        if (e > worst) {
+            worst = e;
+            worst_x = input(i);
+        }
+    }
+
+    printf("%s(%s) in [%g, %g]: max error %.2f ulp at %g\n",
+           op_names[op], type_name, (double)lo, (double)hi, worst, (double)worst_x);
+
+    if (worst > max_ulps) {
+        printf("Error in vectorized %s(%s) is more than %g ulp\n",
+               op_names[op], type_name, max_ulps);
+        return false;
+    }
+
+    if (times[1] > times[0]) {
+        printf("Vectorized %s(%s) is slower than the scalar version. "
+               "Was it scalarized into libm calls?\n",
+               op_names[op], type_name);
+        return false;
+    }
+
+    return true;
+}
+
+// Check the vectorized version on arguments that are out of range for
+// the polynomial approximations, infinite or NaN, mixed into vectors
+// with ordinary arguments. Sine and cosine fall back to libm for those,
+// so they should match the scalar version exactly.
+template<typename T>
+bool test_special_values(const Target &target, Op op, double max_ulps) {
+    const T inf = std::numeric_limits<T>::infinity();
+    const T nan = std::numeric_limits<T>::quiet_NaN();
+    std::vector<T> values = {0, -0.0f, 1, -1, 0.5f, 3, 100, -100, 1e4f, -3e7f, 1e20f,
+                             std::numeric_limits<T>::max(), std::numeric_limits<T>::denorm_min(),
+                             inf, -inf, nan};
+    if (sizeof(T) == 8) {
+        values.push_back((T)1e9);
+        values.push_back((T)-2e9);
+        values.push_back((T)1e300);
+    }
+
+    // Every value in every lane, next to every other value.
+    const int n = (int)values.size();
+    Buffer<T> input(n * n);
+    for (int i = 0; i < n; i++) {
+        for (int j = 0; j < n; j++) {
+            input(i * n + j) = (j % 2) ? values[i] : values[(i + j) % n];
+        }
+    }
+
+    Var x;
+    Buffer<T> outputs[2] = {Buffer<T>(n * n), Buffer<T>(n * n)};
+    for (int i = 0; i < 2; i++) {
+        Func f;
+        f(x) = apply(op, input(x));
+        if (i == 1) {
+            f.vectorize(x, target.natural_vector_size<T>());
+        }
+        f.realize(outputs[i], target);
+    }
+
+    const char *type_name = sizeof(T) == 4 ? "float" : "double";
+    for (int i = 0; i < n * n; i++) {
+        T in = input(i), scalar = outputs[0](i), vector = outputs[1](i);
+        bool is_large = !(std::fabs(in) <= (sizeof(T) == 4 ? 8192 : 1e9));
+        bool ok = ulps(vector, reference(op, in)) <= max_ulps;
+        if ((op == Sin || op == Cos) && is_large) {
+            ok = (vector == scalar) || (std::isnan(vector) && std::isnan(scalar));
+        }
+        if (!ok) {
+            printf("Vectorized %s(%s) of %g is %g, but the scalar version gives %g\n",
+                   op_names[op], type_name, (double)in, (double)vector, (double)scalar);
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+
+    if (!test<float>(target, Sin, -100.0f, 100.0f, 4) ||
+        !test<float>(target, Cos, -100.0f, 100.0f, 4) ||
+        !test<float>(target, Exp, -87.0f, 88.0f, 4) ||
+        !test<float>(target, Log, 1e-30f, 1e30f, 4) ||
+        !test<double>(target, Sin, -1e6, 1e6, 4) ||
+        !test<double>(target, Cos, -1e6, 1e6, 4) ||
+        !test<double>(target, Exp, -700.0, 700.0, 4) ||
+        !test<double>(target, Log, 1e-300, 1e300, 4)) {
+        return -1;
+    }
+
+    if (!test_special_values<float>(target, Sin, 4) ||
+        !test_special_values<float>(target, Cos, 4) ||
+        !test_special_values<double>(target, Sin, 4) ||
+        !test_special_values<double>(target, Cos, 4) ||
+        !test_special_values<double>(target, Exp, 4) ||
+        !test_special_values<double>(target, Log, 4)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
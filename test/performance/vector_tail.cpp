@@ -0,0 +1,96 @@
+#include "Halide.h"
+#include <cstdio>
+#include "halide_benchmark.h"
+
+using namespace Halide;
+using namespace Halide::Tools;
+
+template<typename A>
+const char *string_of_type();
+
+#define DECL_SOT(name)                                          \
+    template<>                                                  \
+    const char *string_of_type<name>() {return #name;}
+
+DECL_SOT(uint8_t);
+DECL_SOT(uint16_t);
+DECL_SOT(float);
+DECL_SOT(double);
+
+// Compare tail strategies for a vectorized stencil on an image whose
+// width is one less than a multiple of the vector width, so that
+// almost a whole vector is left over in every row.
+template<typename A>
+bool test(const Target &target, bool expect_masked_tail) {
+    const int vec = target.natural_vector_size<A>();
+    const int W = vec * 4 - 1, H = 20000;
+
+    Buffer<A> input(W + 2, H);
+    for (int y = 0; y < input.height(); y++) {
+        for (int x = 0; x < input.width(); x++) {
+            input(x, y) = (A)(rand() & 0x3f);
+        }
+    }
+
+    Var x, y;
+    Func f[2];
+    TailStrategy tails[] = {TailStrategy::ShiftInwards, TailStrategy::GuardWithIf};
+    const char *tail_names[] = {"ShiftInwards", "GuardWithIf"};
+    double times[2];
+    Buffer<A> outputs[2] = {Buffer<A>(W, H), Buffer<A>(W, H)};
+    for (int i = 0; i < 2; i++) {
+        f[i](x, y) = input(x, y) + input(x + 1, y) * 2 + input(x + 2, y);
+        f[i].split(x, x, Var("xi"), vec, tails[i]).vectorize(Var("xi"));
+        f[i].compile_jit(target);
+        f[i].realize(outputs[i]);
+        BenchmarkStatistics stats = benchmark_statistics([&]() { f[i].realize(outputs[i]); });
+        report_benchmark(std::string("vector_tail/") + string_of_type<A>() + "/" + tail_names[i], stats);
+        times[i] = stats.min;
+    }
+
+    for (int y = 0; y < H; y++) {
+        for (int x = 0; x < W; x++) {
+            A correct = (A)(input(x, y) + input(x + 1, y) * 2 + input(x + 2, y));
+            for (int i = 0; i < 2; i++) {
+                if (outputs[i](x, y) != correct) {
+                    printf("%s (tail strategy %d) failed at %d %d: %f instead of %f\n",
+                           string_of_type<A>(), i, x, y,
+                           (double)outputs[i](x, y), (double)correct);
+                    return false;
+                }
+            }
+        }
+    }
+
+    // With masked loads and stores, the tail of the GuardWithIf
+    // version is a single predicated vector iteration, which should
+    // be about as cheap as the shifted vector iteration.
+    if (expect_masked_tail && times[1] > times[0] * 1.5) {
+        printf("GuardWithIf is much slower than ShiftInwards. "
+               "Was the tail case scalarized?\n");
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv) {
+    Target target = get_jit_target_from_environment();
+    if (target.arch != Target::X86) {
+        printf("Skipping test: masked vector tails are only implemented on x86\n");
+        return 0;
+    }
+
+    bool avx512bw = target.features_any_of({Target::AVX512_Skylake, Target::AVX512_Cannonlake});
+    bool avx = avx512bw || target.features_any_of({Target::AVX512, Target::AVX512_KNL, Target::AVX, Target::AVX2});
+
+    if (!test<uint8_t>(target, avx512bw) ||
+        !test<uint16_t>(target, avx512bw) ||
+        !test<float>(target, avx) ||
+        !test<double>(target, avx)) {
+        return -1;
+    }
+
+    printf("Success!\n");
+    return 0;
+}
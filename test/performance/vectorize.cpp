@@ -58,12 +58,16 @@ bool test(int vec_width) {
     Buffer<A> outputg = g.realize(W, H);
     Buffer<A> outputf = f.realize(W, H);
 
-    double t_g = benchmark([&]() {
+    BenchmarkStatistics s_g = benchmark_statistics([&]() {
         g.realize(outputg);
     });
-    double t_f = benchmark([&]() {
+    BenchmarkStatistics s_f = benchmark_statistics([&]() {
         f.realize(outputf);
     });
+    std::string name = std::string("vectorize/") + string_of_type<A>() + "x" + std::to_string(vec_width);
+    report_benchmark(name + "/scalar", s_g);
+    report_benchmark(name + "/vectorized", s_f);
+    double t_g = s_g.min, t_f = s_f.min;
 
     for (int y = 0; y < H; y++) {
         for (int x = 0; x < W; x++) {
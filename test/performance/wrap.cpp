@@ -129,17 +129,17 @@ int main(int argc, char **argv) {
     Buffer<int> out2(1000, 1000);
     Buffer<int> out3(1000, 1000);
 
-    double shared_time = benchmark([&]() {
+    BenchmarkStatistics shared_stats = benchmark_statistics([&]() {
             use_shared.realize(out1);
             out1.device_sync();
         });
 
-    double l1_time = benchmark([&]() {
+    BenchmarkStatistics l1_stats = benchmark_statistics([&]() {
             use_l1.realize(out2);
             out2.device_sync();
         });
 
-    double wrap_time = benchmark([&]() {
+    BenchmarkStatistics wrap_stats = benchmark_statistics([&]() {
             use_wrap_for_shared.realize(out3);
             out3.device_sync();
         });
@@ -168,10 +168,9 @@ int main(int argc, char **argv) {
         }
     }
 
-    printf("using shared: %f\n"
-           "using l1: %f\n"
-           "using wrap for shared: %f\n",
-           shared_time, l1_time, wrap_time);
+    report_benchmark("wrap/shared", shared_stats);
+    report_benchmark("wrap/l1", l1_stats);
+    report_benchmark("wrap/wrap_for_shared", wrap_stats);
 
     return 0;
 }
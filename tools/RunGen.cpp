@@ -3,15 +3,21 @@
 #include "halide_benchmark.h"
 #include "halide_image_io.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 extern "C" int halide_rungen_redirect_argv(void **args);
@@ -167,6 +173,19 @@ void rungen_halide_error(void *user_context, const char *message) {
     fail() << "halide_error: " << message;
 }
 
+// Replace the standard Halide thread pool, to run parallel loops serially
+// on the calling thread when --benchmark_thread_pool=serial is specified.
+int rungen_serial_do_par_for(void *user_context, halide_task_t f,
+                             int min, int size, uint8_t *closure) {
+    for (int x = min; x < min + size; x++) {
+        int result = f(user_context, x, closure);
+        if (result) {
+            return result;
+        }
+    }
+    return 0;
+}
+
 // Utility class for installing memory-tracking machinery into the Halide runtime
 // when --track_memory is specified.
 class HalideMemoryTracker {
@@ -617,7 +636,9 @@ Buffer<> load_input_from_file(const std::string &pathname,
                               const halide_filter_argument_t &metadata) {
     Buffer<> b = Buffer<>(metadata.type, 0);
     info() << "Loading input " << metadata.name << " from " << pathname << " ...";
-    if (!Halide::Tools::load<Buffer<>, IOCheckFail>(pathname, &b)) {
+    // Large raw inputs are memory-mapped rather than copied, if their
+    // layout on disk allows it.
+    if (!Halide::Tools::load_mapped<Buffer<>, IOCheckFail>(pathname, &b)) {
         fail() << "Unable to load input: " << pathname;
     }
     if (b.dimensions() != metadata.dimensions) {
@@ -632,27 +653,207 @@ Buffer<> load_input_from_file(const std::string &pathname,
     return b;
 }
 
+// Split a comma-separated list of inputs, ignoring commas inside
+// brackets (as in zero:[1,2,3]).
+std::vector<std::string> split_input_list(const std::string &inputs) {
+    std::vector<std::string> result(1);
+    int depth = 0;
+    for (char c : inputs) {
+        if (c == '[') {
+            depth++;
+        } else if (c == ']') {
+            depth--;
+        }
+        if (c == ',' && depth == 0) {
+            result.emplace_back();
+        } else {
+            result.back() += c;
+        }
+    }
+    return result;
+}
+
+// The parameters of a pseudo-file input other than zero:[...].
+struct PseudoInput {
+    enum Kind { Constant, Uniform, Gaussian, Gradient } kind;
+    halide_scalar_value_t value;  // for Constant
+    uint64_t seed;                // for Uniform and Gaussian
+    bool default_distribution;    // for Gaussian; otherwise use mean and stddev
+    double mean, stddev;
+};
+
+// A counter-based random number generator (SplitMix64), so that the
+// value of each element depends only on the seed and its index, and
+// elements can be generated in any order.
+inline uint64_t random_bits(uint64_t seed, uint64_t index) {
+    uint64_t x = seed * 0x9e3779b97f4a7c15ULL + index;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+// A random double in [0, 1).
+inline double random_unit(uint64_t seed, uint64_t index) {
+    return (random_bits(seed, index) >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Map [0, 1] to the range of values we generate for a type: [0, 1] for
+// floating-point types, and the whole range of integer types.
+template<typename T>
+double from_unit(double u) {
+    if (!std::numeric_limits<T>::is_integer) {
+        return u;
+    }
+    const double lo = (double) std::numeric_limits<T>::lowest();
+    const double hi = (double) std::numeric_limits<T>::max();
+    return lo + u * (hi - lo);
+}
+
+// Convert to T, rounding and clamping to the range of integer types.
+template<typename T>
+T saturating_cast(double v) {
+    if (!std::numeric_limits<T>::is_integer) {
+        return (T) v;
+    }
+    v = std::round(v);
+    if (v <= (double) std::numeric_limits<T>::lowest()) {
+        return std::numeric_limits<T>::lowest();
+    }
+    if (v >= (double) std::numeric_limits<T>::max()) {
+        return std::numeric_limits<T>::max();
+    }
+    return (T) v;
+}
+
+// Call f(begin, end) on disjoint ranges covering [0, size), on as many
+// threads as there are cores.
+template<typename Fn>
+void parallel_for_ranges(size_t size, Fn f) {
+    const size_t min_range = 64 * 1024;
+    const size_t threads = std::max<size_t>(1, std::min<size_t>(std::thread::hardware_concurrency(),
+                                                                size / min_range));
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; t++) {
+        pool.emplace_back(f, size * t / threads, size * (t + 1) / threads);
+    }
+    f(0, size / threads);
+    for (auto &thread : pool) {
+        thread.join();
+    }
+}
+
+// Functor to fill a dense planar buffer with a pseudo-file input, for
+// use with dynamic_type_dispatch.
+template<typename T>
+struct PseudoInputFiller {
+    void operator()(Buffer<> &b, const PseudoInput &input) {
+        T *data = (T *) b.data();
+        const size_t width = b.dim(0).extent();
+        const size_t height = b.dimensions() > 1 ? b.dim(1).extent() : 1;
+        switch (input.kind) {
+        case PseudoInput::Constant: {
+            const T value = *(const T *) &input.value;
+            parallel_for_ranges(b.number_of_elements(), [=](size_t begin, size_t end) {
+                std::fill(data + begin, data + end, value);
+            });
+            break;
+        }
+        case PseudoInput::Uniform: {
+            const uint64_t seed = input.seed;
+            parallel_for_ranges(b.number_of_elements(), [=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    data[i] = saturating_cast<T>(from_unit<T>(random_unit(seed, i)));
+                }
+            });
+            break;
+        }
+        case PseudoInput::Gaussian: {
+            const uint64_t seed = input.seed;
+            const double mean = input.default_distribution ? from_unit<T>(0.5) : input.mean;
+            const double stddev = input.default_distribution ? (from_unit<T>(1) - from_unit<T>(0)) / 8 : input.stddev;
+            parallel_for_ranges(b.number_of_elements(), [=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    // Box-Muller transform
+                    const double u1 = 1.0 - random_unit(seed, 2 * i);
+                    const double u2 = random_unit(seed, 2 * i + 1);
+                    const double z = std::sqrt(-2 * std::log(u1)) * std::cos(2 * M_PI * u2);
+                    data[i] = saturating_cast<T>(mean + stddev * z);
+                }
+            });
+            break;
+        }
+        case PseudoInput::Gradient: {
+            const bool two_d = b.dimensions() > 1;
+            parallel_for_ranges(b.number_of_elements(), [=](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    const size_t x = i % width, y = (i / width) % height;
+                    double u = width > 1 ? (double) x / (width - 1) : 0;
+                    if (two_d) {
+                        u = (u + (height > 1 ? (double) y / (height - 1) : 0)) / 2;
+                    }
+                    data[i] = saturating_cast<T>(from_unit<T>(u));
+                }
+            });
+            break;
+        }
+        }
+    }
+};
+
+template<>
+struct PseudoInputFiller<void*> {
+    void operator()(Buffer<> &b, const PseudoInput &input) {
+        fail() << "Pseudo-file inputs of handle type are not supported";
+    }
+};
+
 Buffer<> load_input(const std::string &pathname,
                     const halide_filter_argument_t &metadata) {
     std::vector<std::string> v = split_string(pathname, ":");
-    if (v.size() != 2 || v[0].size() == 1) {
+    if (v.size() < 2 || v[0].size() == 1 || v.back().empty() || v.back()[0] != '[') {
         return load_input_from_file(pathname, metadata);
     }
 
-    // Assume it's a special std::string of the form key:values
-    if (v[0] == "zero") {
-        auto shape = parse_extents(v[1]);
+    // Assume it's a special std::string of the form key:params...:[extents]
+    const std::string &key = v[0];
+    const std::vector<std::string> params(v.begin() + 1, v.end() - 1);
+    auto shape = parse_extents(v.back());
+    if (key == "zero" && params.empty()) {
         Buffer<> b = allocate_buffer(metadata.type, shape);
         memset(b.data(), 0, b.size_in_bytes());
         return b;
     }
 
-    // TODO: add random options.
-    // TODO: add granger-rainbow.
-    // TODO: add gradients.
+    PseudoInput input;
+    input.default_distribution = true;
+    if (key == "constant" && params.size() == 1) {
+        input.kind = PseudoInput::Constant;
+        if (!parse_scalar(metadata.type, params[0], &input.value)) {
+            fail() << "Value for " << metadata.name << " could not be parsed as type "
+                   << metadata.type << ": " << params[0];
+        }
+    } else if ((key == "uniform" && params.size() == 1) ||
+               (key == "gaussian" && (params.size() == 1 || params.size() == 3))) {
+        input.kind = (key == "uniform") ? PseudoInput::Uniform : PseudoInput::Gaussian;
+        if (!parse_scalar(params[0], &input.seed)) {
+            fail() << "Invalid seed: " << params[0];
+        }
+        if (params.size() == 3) {
+            input.default_distribution = false;
+            if (!parse_scalar(params[1], &input.mean) ||
+                !parse_scalar(params[2], &input.stddev)) {
+                fail() << "Invalid mean and standard deviation: " << params[1] << ", " << params[2];
+            }
+        }
+    } else if (key == "gradient" && params.empty()) {
+        input.kind = PseudoInput::Gradient;
+    } else {
+        fail() << "Unknown input: " << pathname;
+    }
 
-    fail() << "Unknown input: " << pathname;
-    return Buffer<>();
+    Buffer<> b = allocate_buffer(metadata.type, shape);
+    dynamic_type_dispatch<PseudoInputFiller>(metadata.type, b, input);
+    return b;
 }
 
 struct ArgData {
@@ -661,6 +862,9 @@ struct ArgData {
     std::string raw_string;
     halide_scalar_value_t scalar_value;
     Buffer<> buffer_value;
+    // Further inputs of the same shape as buffer_value, to rotate
+    // through when benchmarking throughput.
+    std::vector<Buffer<>> rotated_values;
 };
 
 // Run a bounds-query call with the given args, and return the shapes
@@ -728,6 +932,117 @@ uint64_t calc_pixels_out(const std::map<std::string, ArgData> &args) {
     return pixels_out;
 }
 
+struct ThroughputResult {
+    uint64_t invocations;
+    double wall_time;
+    // The distribution of the latency of each invocation.
+    Halide::Tools::BenchmarkStatistics latencies;
+};
+
+// Invoke the filter on the given number of threads at once, for at least
+// min_time seconds, and time each invocation. Each thread has its own
+// outputs, and rotates through the inputs (if more than one was given
+// for any argument).
+ThroughputResult run_throughput_benchmark(const std::map<std::string, ArgData> &args,
+                                          int threads, double min_time) {
+    using BenchmarkClock = Halide::Tools::SteadyClock<>::type;
+
+    size_t variants = 1;
+    for (auto &arg_pair : args) {
+        variants = std::max(variants, arg_pair.second.rotated_values.size() + 1);
+    }
+
+    std::atomic<int> ready(0);
+    std::atomic<bool> go(false);
+    BenchmarkClock::time_point deadline;
+    std::vector<std::vector<double>> latencies(threads);
+
+    auto worker = [&](int t) {
+        // Buffers are shallow copies, so that each thread passes its own
+        // halide_buffer_t to the filter.
+        std::vector<Buffer<>> buffers;
+        buffers.reserve(args.size() * variants);
+        std::vector<size_t> outputs;
+        std::vector<std::vector<void*>> filter_argvs(variants, std::vector<void*>(args.size(), nullptr));
+        for (auto &arg_pair : args) {
+            auto &arg = arg_pair.second;
+            switch (arg.metadata->kind) {
+            case halide_argument_kind_input_scalar:
+                for (size_t v = 0; v < variants; v++) {
+                    filter_argvs[v][arg.index] = const_cast<halide_scalar_value_t*>(&arg.scalar_value);
+                }
+                break;
+            case halide_argument_kind_input_buffer:
+                for (size_t v = 0; v < variants; v++) {
+                    size_t i = v % (arg.rotated_values.size() + 1);
+                    buffers.push_back(i == 0 ? arg.buffer_value : arg.rotated_values[i - 1]);
+                    filter_argvs[v][arg.index] = buffers.back().raw_buffer();
+                }
+                break;
+            case halide_argument_kind_output_buffer:
+                outputs.push_back(buffers.size());
+                buffers.push_back(allocate_buffer(arg.metadata->type, get_shape(arg.buffer_value)));
+                for (size_t v = 0; v < variants; v++) {
+                    filter_argvs[v][arg.index] = buffers.back().raw_buffer();
+                }
+                break;
+            }
+        }
+
+        auto invoke = [&](size_t v) {
+            // Ignore result since our halide_error() should catch everything.
+            (void) halide_rungen_redirect_argv(&filter_argvs[v][0]);
+            // As below, ensure that all outputs are finished.
+            for (size_t i : outputs) {
+                buffers[i].device_sync();
+            }
+        };
+
+        // Warm up, then wait for the other threads to do the same.
+        invoke(0);
+        ready++;
+        while (!go) {
+            std::this_thread::yield();
+        }
+
+        // Start each thread at a different input, so that they don't
+        // all read the same one at once.
+        size_t v = t % variants;
+        do {
+            auto start = BenchmarkClock::now();
+            invoke(v);
+            auto end = BenchmarkClock::now();
+            latencies[t].push_back(std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count());
+            v = (v + 1) % variants;
+        } while (BenchmarkClock::now() < deadline);
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; t++) {
+        pool.emplace_back(worker, t);
+    }
+    while (ready < threads) {
+        std::this_thread::yield();
+    }
+    auto start = BenchmarkClock::now();
+    deadline = start + std::chrono::duration_cast<BenchmarkClock::duration>(std::chrono::duration<double>(min_time));
+    go = true;
+    for (auto &thread : pool) {
+        thread.join();
+    }
+    auto end = BenchmarkClock::now();
+
+    ThroughputResult result;
+    result.wall_time = std::chrono::duration_cast<std::chrono::duration<double>>(end - start).count();
+    std::vector<double> all_latencies;
+    for (auto &l : latencies) {
+        all_latencies.insert(all_latencies.end(), l.begin(), l.end());
+    }
+    result.invocations = all_latencies.size();
+    result.latencies = Halide::Tools::compute_benchmark_statistics(std::move(all_latencies), result.invocations);
+    return result;
+}
+
 void usage(const char *argv0) {
 const std::string usage = R"USAGE(
 Usage: $NAME$ argument=value [argument=value... ] [flags]
@@ -745,13 +1060,11 @@ Arguments:
         some_input_buffer=/path/to/existing/file.png
         some_output_buffer=/path/to/create/output/file.png
 
-    We currently support JPG, PGM, PNG, PPM format. If the type or dimensions
-    of the input or output file type can't support the data (e.g., your filter
-    uses float32 input and output, and you load/save to PNG), we'll use the most
-    robust approximation within the format and issue a warning to stdout.
-
-    (We anticipate adding other image formats in the future, in particular,
-    TIFF and TMP.)
+    We currently support JPG, PGM, PNG, PPM, TIFF, TMP and MAT format. If the
+    type or dimensions of the input or output file type can't support the data
+    (e.g., your filter uses float32 input and output, and you load/save to PNG),
+    we'll use the most robust approximation within the format and issue a
+    warning to stdout. (TIFF, TMP and MAT files can hold float data exactly.)
 
     For inputs, there are also "pseudo-file" specifiers you can use; currently
     supported are
@@ -762,8 +1075,30 @@ Arguments:
         set to zero of the appropriate type. (This is useful for benchmarking
         filters that don't have performance variances with different data.)
 
-        (We anticipate adding other pseudo-file inputs in the future, e.g.
-        various random distributions, gradients, rainbows, etc.)
+        constant:VALUE:[NUM,NUM,...]
+
+        All elements set to the given value.
+
+        uniform:SEED:[NUM,NUM,...]
+
+        Uniformly distributed random values over the whole range of an
+        integer type, or over [0, 1] for a floating-point type.
+
+        gaussian:SEED:[NUM,NUM,...]
+        gaussian:SEED:MEAN:STDDEV:[NUM,NUM,...]
+
+        Normally distributed random values, clamped to the range of the
+        type. The default mean is the middle of the range above, and the
+        default standard deviation is an eighth of it.
+
+        gradient:[NUM,NUM,...]
+
+        A linear ramp over the first two dimensions, from the bottom of the
+        range above at [0, 0] to the top of it at the opposite corner.
+
+        Random inputs depend only on the seed and the extents, and are
+        generated in parallel at the type the filter expects, which is
+        useful for benchmarking data-dependent filters.
 
 Flags:
 
@@ -789,10 +1124,35 @@ Flags:
         Don't log calls to halide_print() to stdout.
 
     --benchmarks=all:
-        Run the filter with the given arguments many times to
-        produce an estimate of average execution time; this currently
-        runs "samples" sets of "iterations" each, and chooses the fastest
-        sample set.
+        Run the filter with the given arguments many times, in "samples"
+        sets of "iterations" each, and report the fastest sample set, along
+        with the median, mean, standard deviation and 90th and 99th
+        percentile of the time per iteration over all samples, and the
+        number of outlying samples.
+
+    --benchmarks=throughput:
+        Run many invocations of the filter at once, each on its own thread
+        and with its own outputs, for at least --benchmark_min_time seconds,
+        and report the invocations/sec achieved and the 50th, 90th and 99th
+        percentile latency of an invocation.
+
+        To defeat cache warmness, you can give a comma-separated list of
+        inputs of the same shape for any input argument, e.g.
+
+            input=a.png,b.png,c.png
+
+        and each thread will rotate through them.
+
+    --benchmark_threads=NUM [default = number of cores]:
+        The number of concurrent invocations for --benchmarks=throughput.
+
+    --benchmark_thread_pool=shared|serial [default = shared]:
+        With "shared", concurrent invocations share the Halide thread pool
+        for their parallel loops. With "serial", there is no thread pool:
+        each invocation runs its parallel loops serially on its own thread,
+        so the only parallelism is across invocations. This measures the
+        throughput of running --benchmark_threads single-threaded copies
+        of the pipeline at once.
 
     --benchmark_min_time=DURATION_SECONDS [default = 0.1]:
         Override the default minimum desired benchmarking time; ignored if
@@ -806,6 +1166,14 @@ Flags:
         Override the default maximum number of benchmarking iterations; ignored
         if --benchmarks is not also specified.
 
+    --benchmark_pin_thread:
+        Pin the benchmarking thread to the core it starts on (Linux only);
+        ignored if --benchmarks=all is not also specified.
+
+    --benchmark_json=FILENAME:
+        Also write the benchmark results to the given file as a JSON object,
+        with times in seconds; ignored if --benchmarks is not also specified.
+
     --track_memory:
         Override Halide memory allocator to track high-water mark of memory
         allocation during run; note that this may slow down execution, so
@@ -898,11 +1266,16 @@ int main(int argc, char **argv) {
     Shape default_output_shape;
     std::vector<std::string> unknown_args;
     bool benchmark = false;
+    bool benchmark_throughput = false;
+    int benchmark_threads = std::max(1, (int) std::thread::hardware_concurrency());
+    bool benchmark_shared_thread_pool = true;
     bool track_memory = false;
     bool describe = false;
     double benchmark_min_time = BenchmarkConfig().min_time;
     int benchmark_min_iters = BenchmarkConfig().min_iters;
     int benchmark_max_iters = BenchmarkConfig().max_iters;
+    bool benchmark_pin_thread = false;
+    std::string benchmark_json;
     for (int i = 1; i < argc; ++i) {
         if (argv[i][0] == '-') {
             const char *p = argv[i] + 1; // skip -
@@ -944,10 +1317,20 @@ int main(int argc, char **argv) {
                     fail() << "Invalid value for flag: " << flag_name;
                 }
             } else if (flag_name == "benchmarks") {
-                if (flag_value != "all") {
-                    fail() << "The only valid value for --benchmarks is 'all'";
+                if (flag_value != "all" && flag_value != "throughput") {
+                    fail() << "The only valid values for --benchmarks are 'all' and 'throughput'";
                 }
                 benchmark = true;
+                benchmark_throughput = (flag_value == "throughput");
+            } else if (flag_name == "benchmark_threads") {
+                if (!parse_scalar(flag_value, &benchmark_threads) || benchmark_threads < 1) {
+                    fail() << "Invalid value for flag: " << flag_name;
+                }
+            } else if (flag_name == "benchmark_thread_pool") {
+                if (flag_value != "shared" && flag_value != "serial") {
+                    fail() << "The only valid values for --benchmark_thread_pool are 'shared' and 'serial'";
+                }
+                benchmark_shared_thread_pool = (flag_value == "shared");
             } else if (flag_name == "benchmark_min_time") {
                 if (!parse_scalar(flag_value, &benchmark_min_time)) {
                     fail() << "Invalid value for flag: " << flag_name;
@@ -960,6 +1343,18 @@ int main(int argc, char **argv) {
                 if (!parse_scalar(flag_value, &benchmark_max_iters)) {
                     fail() << "Invalid value for flag: " << flag_name;
                 }
+            } else if (flag_name == "benchmark_pin_thread") {
+                if (flag_value.empty()) {
+                    flag_value = "true";
+                }
+                if (!parse_scalar(flag_value, &benchmark_pin_thread)) {
+                    fail() << "Invalid value for flag: " << flag_name;
+                }
+            } else if (flag_name == "benchmark_json") {
+                if (flag_value.empty()) {
+                    fail() << "Invalid value for flag: " << flag_name;
+                }
+                benchmark_json = flag_value;
             } else if (flag_name == "output_extents") {
                 default_output_shape = parse_extents(flag_value);
             } else {
@@ -1041,7 +1436,14 @@ int main(int argc, char **argv) {
             break;
         }
         case halide_argument_kind_input_buffer: {
-            arg.buffer_value = load_input(arg.raw_string, *arg.metadata);
+            std::vector<std::string> inputs = split_input_list(arg.raw_string);
+            if (inputs.size() > 1 && !benchmark_throughput) {
+                fail() << "Multiple inputs for " << arg_name << " are only supported with --benchmarks=throughput";
+            }
+            arg.buffer_value = load_input(inputs[0], *arg.metadata);
+            for (size_t j = 1; j < inputs.size(); j++) {
+                arg.rotated_values.push_back(load_input(inputs[j], *arg.metadata));
+            }
             info() << "Input " << arg_name << ": Shape is " << get_shape(arg.buffer_value);
             // If there was no default_output_shape specified, use the shape of
             // the first input buffer (if any).
@@ -1073,6 +1475,15 @@ int main(int argc, char **argv) {
                 if (updated) {
                     info() << "Input " << arg_name << ": Updated Shape is " << get_shape(arg.buffer_value);
                 }
+                for (Buffer<> &b : arg.rotated_values) {
+                    adapt_input_buffer_layout(constrained_shape, &b);
+                    for (int d = 0; d < b.dimensions(); d++) {
+                        if (b.dim(d).min() != arg.buffer_value.dim(d).min() ||
+                            b.dim(d).extent() != arg.buffer_value.dim(d).extent()) {
+                            fail() << "All inputs for " << arg_name << " must have the same shape";
+                        }
+                    }
+                }
                 break;
             }
             case halide_argument_kind_output_buffer: {
@@ -1108,7 +1519,40 @@ int main(int argc, char **argv) {
             }
         }
 
-        if (benchmark) {
+        if (benchmark_throughput) {
+            info() << "Benchmarking filter throughput...";
+
+            halide_do_par_for_t old_do_par_for = nullptr;
+            if (!benchmark_shared_thread_pool) {
+                old_do_par_for = halide_set_custom_do_par_for(rungen_serial_do_par_for);
+            }
+            auto result = run_throughput_benchmark(args, benchmark_threads, benchmark_min_time);
+            if (!benchmark_shared_thread_pool) {
+                halide_set_custom_do_par_for(old_do_par_for);
+            }
+
+            const double per_sec = result.invocations / result.wall_time;
+            std::cout << "Throughput benchmark for " << md->name << " with " << benchmark_threads
+                << " concurrent invocations ("
+                << (benchmark_shared_thread_pool ? "shared thread pool" : "serial parallel loops")
+                << ") produces " << per_sec << " invocations/sec (over "
+                << result.invocations << " invocations in " << result.wall_time << " sec).\n";
+            std::cout << "Latency per invocation is " << result.latencies.median << " sec (p50), "
+                << result.latencies.percentile(90) << " sec (p90), "
+                << result.latencies.percentile(99) << " sec (p99).\n";
+            std::cout << "Output throughput is " << (megapixels * per_sec) << " mpix/sec.\n";
+            if (!benchmark_json.empty()) {
+                std::ofstream f(benchmark_json);
+                Halide::Tools::write_json(f, md->name, result.latencies,
+                                          {{"threads", benchmark_threads},
+                                           {"wall_time", result.wall_time},
+                                           {"invocations_per_sec", per_sec},
+                                           {"mpix_per_sec", megapixels * per_sec}});
+                if (!f) {
+                    fail() << "Unable to write " << benchmark_json;
+                }
+            }
+        } else if (benchmark) {
             const auto benchmark_inner = [&filter_argv, &args]() {
                 // Ignore result since our halide_error() should catch everything.
                 (void) halide_rungen_redirect_argv(&filter_argv[0]);
@@ -1130,13 +1574,28 @@ int main(int argc, char **argv) {
             config.max_time = benchmark_min_time * 4;
             config.min_iters = benchmark_min_iters;
             config.max_iters = benchmark_max_iters;
-            auto result = Halide::Tools::benchmark(benchmark_inner, config);
+            config.pin_thread = benchmark_pin_thread;
+            auto result = Halide::Tools::benchmark_statistics(benchmark_inner, config);
 
-            std::cout << "Benchmark for " << md->name << " produces best case of " << result.wall_time << " sec/iter (over "
-                << result.samples << " samples, "
+            std::cout << "Benchmark for " << md->name << " produces best case of " << result.min << " sec/iter (over "
+                << result.samples() << " samples, "
                 << result.iterations << " iterations, "
-                << "accuracy " << std::setprecision(2) << (result.accuracy * 100.0) << "%).\n";
-            std::cout << "Best output throughput is " << (megapixels / result.wall_time) << " mpix/sec.\n";
+                << "accuracy " << std::setprecision(2) << (result.accuracy() * 100.0) << "%).\n";
+            std::cout << std::setprecision(6) << "Time per iteration is " << result.median << " sec (median), "
+                << result.mean << " sec (mean), "
+                << result.stddev << " sec (stddev), "
+                << result.percentile(90) << " sec (p90), "
+                << result.percentile(99) << " sec (p99), with "
+                << (result.low_outliers + result.high_outliers) << " outlying samples.\n";
+            std::cout << "Best output throughput is " << (megapixels / result.min) << " mpix/sec.\n";
+            if (!benchmark_json.empty()) {
+                std::ofstream f(benchmark_json);
+                Halide::Tools::write_json(f, md->name, result,
+                                          {{"best_mpix_per_sec", megapixels / result.min}});
+                if (!f) {
+                    fail() << "Unable to write " << benchmark_json;
+                }
+            }
 
         } else {
             info() << "Running filter...";
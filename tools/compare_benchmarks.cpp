@@ -0,0 +1,186 @@
+// Compare a set of benchmark results against a baseline, and fail if
+// any of them have regressed by more than a threshold.
+//
+// Both files are JSON Lines files, with one JSON object per line as
+// written by Halide::Tools::write_json() (see halide_benchmark.h); blank
+// lines are ignored. Each object must have a "name"
+// and a numeric value for the metric being compared. An object in the
+// baseline may also have a "threshold", which overrides the default for
+// that benchmark.
+//
+// Usage: compare_benchmarks [--threshold=0.1] [--metric=median] baseline.jsonl results.jsonl
+
+#include <cctype>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <string>
+
+namespace {
+
+typedef std::map<std::string, std::string> Record;
+
+// Parse a flat JSON object (string and number values only) into a map
+// from keys to values; string values are unescaped. Returns false if
+// the line isn't one.
+bool parse_record(const std::string &line, Record *record) {
+    size_t i = 0;
+    auto skip_space = [&]() {
+        while (i < line.size() && isspace((unsigned char) line[i])) {
+            i++;
+        }
+    };
+    auto parse_string = [&](std::string *s) {
+        if (i >= line.size() || line[i] != '"') {
+            return false;
+        }
+        for (i++; i < line.size() && line[i] != '"'; i++) {
+            if (line[i] == '\\' && i + 1 < line.size()) {
+                i++;
+                if (line[i] == 'u' && i + 4 < line.size()) {
+                    *s += (char) strtol(line.substr(i + 1, 4).c_str(), nullptr, 16);
+                    i += 4;
+                    continue;
+                }
+            }
+            *s += line[i];
+        }
+        return i++ < line.size();
+    };
+
+    skip_space();
+    if (i >= line.size() || line[i++] != '{') {
+        return false;
+    }
+    skip_space();
+    if (i < line.size() && line[i] == '}') {
+        return true;
+    }
+    while (true) {
+        std::string key, value;
+        skip_space();
+        if (!parse_string(&key)) {
+            return false;
+        }
+        skip_space();
+        if (i >= line.size() || line[i++] != ':') {
+            return false;
+        }
+        skip_space();
+        if (i < line.size() && line[i] == '"') {
+            if (!parse_string(&value)) {
+                return false;
+            }
+        } else {
+            while (i < line.size() && line[i] != ',' && line[i] != '}' && !isspace((unsigned char) line[i])) {
+                value += line[i++];
+            }
+        }
+        (*record)[key] = value;
+        skip_space();
+        if (i < line.size() && line[i] == ',') {
+            i++;
+        } else if (i < line.size() && line[i] == '}') {
+            return true;
+        } else {
+            return false;
+        }
+    }
+}
+
+// Load the value of the given metric for each benchmark in a file. If
+// a benchmark appears more than once, the last one wins.
+bool load_results(const std::string &filename, const std::string &metric,
+                  std::map<std::string, double> *values,
+                  std::map<std::string, double> *thresholds) {
+    std::ifstream f(filename);
+    if (!f) {
+        fprintf(stderr, "Could not open %s\n", filename.c_str());
+        return false;
+    }
+    std::string line;
+    for (int line_number = 1; std::getline(f, line); line_number++) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos) {
+            continue;
+        }
+        Record record;
+        if (!parse_record(line, &record) || !record.count("name") || !record.count(metric)) {
+            fprintf(stderr, "%s:%d: Expected a JSON object with a \"name\" and a \"%s\"\n",
+                    filename.c_str(), line_number, metric.c_str());
+            return false;
+        }
+        const std::string &name = record["name"];
+        (*values)[name] = atof(record[metric].c_str());
+        if (thresholds && record.count("threshold")) {
+            (*thresholds)[name] = atof(record["threshold"].c_str());
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    double default_threshold = 0.1;
+    std::string metric = "median";
+    std::string files[2];
+    int num_files = 0;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.compare(0, 12, "--threshold=") == 0) {
+            default_threshold = atof(arg.c_str() + 12);
+        } else if (arg.compare(0, 9, "--metric=") == 0) {
+            metric = arg.substr(9);
+        } else if (arg[0] != '-' && num_files < 2) {
+            files[num_files++] = arg;
+        } else {
+            num_files = 0;
+            break;
+        }
+    }
+    if (num_files != 2 || default_threshold < 0) {
+        fprintf(stderr, "Usage: %s [--threshold=0.1] [--metric=median] baseline.jsonl results.jsonl\n", argv[0]);
+        return 1;
+    }
+
+    std::map<std::string, double> baseline, thresholds, results;
+    if (!load_results(files[0], metric, &baseline, &thresholds) ||
+        !load_results(files[1], metric, &results, nullptr)) {
+        return 1;
+    }
+
+    int regressions = 0, improvements = 0, added = 0;
+    printf("%-50s %12s %12s %8s\n", "benchmark", "baseline", "result", "change");
+    for (const auto &r : results) {
+        auto b = baseline.find(r.first);
+        if (b == baseline.end() || b->second <= 0) {
+            printf("%-50s %12s %12.4g %8s  new\n", r.first.c_str(), "-", r.second, "-");
+            added++;
+            continue;
+        }
+        double threshold = thresholds.count(r.first) ? thresholds[r.first] : default_threshold;
+        double ratio = r.second / b->second;
+        const char *status = "";
+        if (ratio > 1 + threshold) {
+            status = "REGRESSED";
+            regressions++;
+        } else if (ratio * (1 + threshold) < 1) {
+            status = "improved";
+            improvements++;
+        }
+        printf("%-50s %12.4g %12.4g %+7.1f%%  %s\n", r.first.c_str(), b->second, r.second,
+               (ratio - 1) * 100, status);
+    }
+    for (const auto &b : baseline) {
+        if (!results.count(b.first)) {
+            printf("%-50s %12.4g %12s %8s  missing\n", b.first.c_str(), b.second, "-", "-");
+        }
+    }
+
+    printf("\n%d benchmarks compared by %s: %d regressed, %d improved, %d new (default threshold %g%%)\n",
+           (int) results.size() - added, metric.c_str(), regressions, improvements, added,
+           default_threshold * 100);
+    return regressions ? 1 : 0;
+}
@@ -4,8 +4,21 @@
 #include <algorithm>
 #include <cassert>
 #include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <functional>
 #include <limits>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace Halide {
 namespace Tools {
@@ -94,6 +107,51 @@ struct BenchmarkConfig {
     // this. Controls accuracy. The closer to zero this gets the more
     // reliable the answer, but the longer it may take to run.
     double accuracy{0.03};
+
+    // Take at least this many samples. Only used by benchmark_statistics().
+    uint64_t min_samples{10};
+
+    // Pin the calling thread to the core it is running on while
+    // benchmarking, so that its samples aren't perturbed by migrating
+    // between cores. (Currently only supported on Linux; ignored
+    // elsewhere.)
+    bool pin_thread{false};
+};
+
+// Pins the calling thread to its current core for the lifetime of
+// this object, then restores its previous affinity.
+class PinCurrentThread {
+#ifdef __linux__
+    cpu_set_t old_affinity;
+    bool pinned{false};
+
+public:
+    explicit PinCurrentThread(bool pin = true) {
+        if (!pin) {
+            return;
+        }
+        int cpu = sched_getcpu();
+        if (cpu < 0 || pthread_getaffinity_np(pthread_self(), sizeof(old_affinity), &old_affinity) != 0) {
+            return;
+        }
+        cpu_set_t affinity;
+        CPU_ZERO(&affinity);
+        CPU_SET(cpu, &affinity);
+        pinned = pthread_setaffinity_np(pthread_self(), sizeof(affinity), &affinity) == 0;
+    }
+
+    ~PinCurrentThread() {
+        if (pinned) {
+            pthread_setaffinity_np(pthread_self(), sizeof(old_affinity), &old_affinity);
+        }
+    }
+#else
+public:
+    explicit PinCurrentThread(bool pin = true) {}
+#endif
+
+    PinCurrentThread(const PinCurrentThread &) = delete;
+    PinCurrentThread &operator=(const PinCurrentThread &) = delete;
 };
 
 struct BenchmarkResult {
@@ -119,6 +177,7 @@ struct BenchmarkResult {
 
 inline BenchmarkResult benchmark(std::function<void()> op, const BenchmarkConfig& config = {}) {
     BenchmarkResult result{0, 0, 0};
+    PinCurrentThread pin(config.pin_thread);
 
     const double min_time = std::max(10 * 1e-6, config.min_time);
     const double max_time = std::max(config.min_time, config.max_time);
@@ -177,6 +236,193 @@ inline BenchmarkResult benchmark(std::function<void()> op, const BenchmarkConfig
     return result;
 }
 
+// The distribution of the time per iteration over a set of samples.
+// Unlike benchmark(), which only reports the best time, this shows how
+// noisy the measurement is, and whether there is a tail of slow
+// iterations (e.g. from thread pool wakeups or frequency scaling).
+// All times are in seconds.
+struct BenchmarkStatistics {
+    // The time per iteration of each sample, in ascending order.
+    std::vector<double> times;
+
+    // Total number of iterations across all samples.
+    uint64_t iterations{0};
+
+    double min{0}, max{0}, mean{0}, median{0};
+
+    // Sample standard deviation.
+    double stddev{0};
+
+    // Number of samples outside Tukey's fences, i.e. more than 1.5 times
+    // the interquartile range below the first quartile or above the
+    // third.
+    uint64_t low_outliers{0}, high_outliers{0};
+
+    uint64_t samples() const { return times.size(); }
+
+    // The p'th percentile (0 <= p <= 100) of the times, interpolating
+    // linearly between samples.
+    double percentile(double p) const {
+        if (times.empty()) {
+            return 0;
+        }
+        double i = std::min(std::max(p, 0.0), 100.0) / 100.0 * (times.size() - 1);
+        size_t lo = (size_t) i;
+        size_t hi = std::min(lo + 1, times.size() - 1);
+        return times[lo] + (i - lo) * (times[hi] - times[lo]);
+    }
+
+    // Relative difference between the best and third-best samples, as
+    // in BenchmarkResult.
+    double accuracy() const {
+        return times.size() < 3 ? 0 : times[2] / times[0] - 1.0;
+    }
+
+    // Use the best time when treated as a double, as BenchmarkResult does.
+    operator double() const { return min; }
+};
+
+// Compute the statistics of a set of times per iteration.
+inline BenchmarkStatistics compute_benchmark_statistics(std::vector<double> times, uint64_t iterations) {
+    BenchmarkStatistics s;
+    s.iterations = iterations;
+    std::sort(times.begin(), times.end());
+    s.times = std::move(times);
+    if (s.times.empty()) {
+        return s;
+    }
+    const size_t n = s.times.size();
+    s.min = s.times.front();
+    s.max = s.times.back();
+    s.median = s.percentile(50);
+    double sum = 0;
+    for (double t : s.times) {
+        sum += t;
+    }
+    s.mean = sum / n;
+    double sum_sq = 0;
+    for (double t : s.times) {
+        sum_sq += (t - s.mean) * (t - s.mean);
+    }
+    s.stddev = n > 1 ? std::sqrt(sum_sq / (n - 1)) : 0;
+    const double q1 = s.percentile(25), q3 = s.percentile(75);
+    const double low_fence = q1 - 1.5 * (q3 - q1), high_fence = q3 + 1.5 * (q3 - q1);
+    for (double t : s.times) {
+        s.low_outliers += (t < low_fence);
+        s.high_outliers += (t > high_fence);
+    }
+    return s;
+}
+
+// Benchmark the operation 'op', and report the distribution of the time
+// per iteration rather than just the best one. Each sample runs enough
+// iterations to take at least ~100us (so that timer overhead doesn't
+// matter), and samples are taken until there are at least
+// config.min_samples of them, min_time has elapsed, and the best and
+// third-best samples are within config.accuracy of each other; or until
+// max_time or max_iters is exceeded.
+inline BenchmarkStatistics benchmark_statistics(std::function<void()> op, const BenchmarkConfig &config = {}) {
+    PinCurrentThread pin(config.pin_thread);
+
+    constexpr double kMinSampleTime = 100 * 1e-6;
+    constexpr uint64_t kMinSamples = 3;
+    const double min_time = std::max(10 * 1e-6, config.min_time);
+    const double max_time = std::max(config.min_time, config.max_time);
+    const uint64_t min_samples = std::max(kMinSamples, config.min_samples);
+    const uint64_t min_iters = std::min(std::max((uint64_t)1, config.min_iters),
+                                        kBenchmarkMaxIterations);
+    const uint64_t max_iters = std::min(
+            std::max(config.min_iters, config.max_iters), kBenchmarkMaxIterations);
+    const double accuracy = 1.0 + std::min(std::max(0.001, config.accuracy), 0.1);
+
+    // Warm up, and find a number of iterations per sample that takes
+    // long enough to time accurately.
+    uint64_t iters_per_sample = min_iters;
+    while (true) {
+        double t = benchmark(1, iters_per_sample, op);
+        if (t * iters_per_sample >= kMinSampleTime || iters_per_sample >= max_iters) {
+            break;
+        }
+        double next_iters = std::max(kMinSampleTime / std::max(t, 1e-9), iters_per_sample * 2.0);
+        iters_per_sample = std::min((uint64_t)(next_iters + 0.5), max_iters);
+    }
+
+    std::vector<double> times;
+    uint64_t iterations = 0;
+    double total_time = 0;
+    // The best kMinSamples times so far, in ascending order.
+    double best[kMinSamples + 1];
+    std::fill(best, best + kMinSamples + 1, std::numeric_limits<double>::infinity());
+    while (times.size() < kMinSamples ||
+           ((times.size() < min_samples || total_time < min_time ||
+             best[0] * accuracy < best[kMinSamples - 1]) &&
+            total_time < max_time &&
+            iterations < max_iters)) {
+        double t = benchmark(1, iters_per_sample, op);
+        times.push_back(t);
+        iterations += iters_per_sample;
+        total_time += t * iters_per_sample;
+        best[kMinSamples] = t;
+        std::sort(best, best + kMinSamples + 1);
+    }
+    return compute_benchmark_statistics(std::move(times), iterations);
+}
+
+// Write a set of statistics as a single-line JSON object, along with
+// its name and any extra values.
+inline void write_json(std::ostream &os, const std::string &name, const BenchmarkStatistics &s,
+                       const std::map<std::string, double> &extra = {}) {
+    std::string escaped;
+    for (char c : name) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+            escaped += c;
+        } else if ((unsigned char) c < 0x20) {
+            char buf[8];
+            snprintf(buf, sizeof(buf), "\\u%04x", c);
+            escaped += buf;
+        } else {
+            escaped += c;
+        }
+    }
+    const auto old_precision = os.precision(9);
+    os << "{\"name\": \"" << escaped << "\""
+       << ", \"samples\": " << s.samples()
+       << ", \"iterations\": " << s.iterations
+       << ", \"min\": " << s.min
+       << ", \"max\": " << s.max
+       << ", \"mean\": " << s.mean
+       << ", \"median\": " << s.median
+       << ", \"stddev\": " << s.stddev
+       << ", \"p90\": " << s.percentile(90)
+       << ", \"p99\": " << s.percentile(99)
+       << ", \"low_outliers\": " << s.low_outliers
+       << ", \"high_outliers\": " << s.high_outliers;
+    for (const auto &e : extra) {
+        os << ", \"" << e.first << "\": " << e.second;
+    }
+    os << "}\n";
+    os.precision(old_precision);
+}
+
+// Print a one-line summary of a set of statistics to stdout and, if the
+// HL_BENCHMARK_JSON environment variable is set, append it as JSON to
+// the file it names. This is how the performance tests report their
+// results.
+inline void report_benchmark(const std::string &name, const BenchmarkStatistics &s,
+                             const std::map<std::string, double> &extra = {}) {
+    printf("%s: min %.4g ms, median %.4g ms, mean %.4g ms, stddev %.2g ms, p90 %.4g ms, p99 %.4g ms "
+           "(%d samples, %d outliers)\n",
+           name.c_str(), s.min * 1e3, s.median * 1e3, s.mean * 1e3, s.stddev * 1e3,
+           s.percentile(90) * 1e3, s.percentile(99) * 1e3,
+           (int) s.samples(), (int) (s.low_outliers + s.high_outliers));
+    const char *path = getenv("HL_BENCHMARK_JSON");
+    if (path && path[0]) {
+        std::ofstream f(path, std::ios::app);
+        write_json(f, name, s, extra);
+    }
+}
+
 }   // namespace Tools
 }   // mamespace Halide
 
@@ -23,7 +23,15 @@
 #include "jpeglib.h"
 #endif
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "HalideRuntime.h"  // for halide_type_t
+#include "HalideBuffer.h"  // for memory-mapped images
 
 namespace Halide {
 namespace Tools {
@@ -967,11 +975,10 @@ enum MatlabClassCode {
     mxUINT64_CLASS = 15
 };
 
-template<typename ImageType, CheckFunc check = CheckReturn>
-bool load_mat(const std::string &filename, ImageType *im) {
-    static_assert(!ImageType::has_static_halide_type, "");
-
-    FileOpener f(filename, "rb");
+// Read the headers of a .mat file, leaving the file positioned at the
+// start of the payload.
+template<CheckFunc check>
+bool read_mat_header(FileOpener &f, halide_type_t *type, std::vector<int> *extents) {
     if (!check(f.f != nullptr, "File could not be opened for reading")) {
         return false;
     }
@@ -1008,8 +1015,8 @@ bool load_mat(const std::string &filename, ImageType *im) {
         return false;
     }
     int dims = shape_header[1]/4;
-    std::vector<int> extents(dims);
-    if (!check(f.read_vector(&extents), "Could not read .mat header\n")) {
+    extents->resize(dims);
+    if (!check(f.read_vector(extents), "Could not read .mat header\n")) {
         return false;
     }
     if (dims & 1) {
@@ -1043,40 +1050,53 @@ bool load_mat(const std::string &filename, ImageType *im) {
     if (!check(f.read_array(payload_header), "Could not read .mat header\n")) {
         return false;
     }
-    halide_type_t type;
     switch (payload_header[0]) {
     case miINT8:
-        type = halide_type_of<int8_t>();
+        *type = halide_type_of<int8_t>();
         break;
     case miINT16:
-        type = halide_type_of<int16_t>();
+        *type = halide_type_of<int16_t>();
         break;
     case miINT32:
-        type = halide_type_of<int32_t>();
+        *type = halide_type_of<int32_t>();
         break;
     case miINT64:
-        type = halide_type_of<int64_t>();
+        *type = halide_type_of<int64_t>();
         break;
     case miUINT8:
-        type = halide_type_of<uint8_t>();
+        *type = halide_type_of<uint8_t>();
         break;
     case miUINT16:
-        type = halide_type_of<uint16_t>();
+        *type = halide_type_of<uint16_t>();
         break;
     case miUINT32:
-        type = halide_type_of<uint32_t>();
+        *type = halide_type_of<uint32_t>();
         break;
     case miUINT64:
-        type = halide_type_of<uint64_t>();
+        *type = halide_type_of<uint64_t>();
         break;
     case miSINGLE:
-        type = halide_type_of<float>();
+        *type = halide_type_of<float>();
         break;
     case miDOUBLE:
-        type = halide_type_of<double>();
+        *type = halide_type_of<double>();
         break;
     }
 
+    return true;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool load_mat(const std::string &filename, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    FileOpener f(filename, "rb");
+    halide_type_t type;
+    std::vector<int> extents;
+    if (!read_mat_header<check>(f, &type, &extents)) {
+        return false;
+    }
+
     *im = ImageType(type, extents);
 
     // This should never fail unless the default Buffer<> constructor behavior changes.
@@ -1301,6 +1321,471 @@ bool save_mat(ImageType &im, const std::string &filename) {
 }
 
 
+// ".tiff" is the Tagged Image File Format documented here:
+// https://www.adobe.io/open/standards/TIFF.html
+//
+// We read uncompressed TIFF files in either byte order, with unsigned,
+// signed or floating-point samples of any size Halide supports
+// (including float16), stored interleaved or planar in any number of
+// strips. The image loaded keeps the layout of the file, so that the
+// payload can be read straight into it: interleaved files load as
+// interleaved images. We write uncompressed TIFF files in the host's
+// byte order, keeping the layout of the image saved. As in
+// halide_debug_to_file, the third dimension of a four-dimensional
+// image is stored with the (non-standard) ImageDepth tag, and the
+// fourth holds the channels.
+
+enum TiffTag {
+    tiffImageWidth = 256,
+    tiffImageLength = 257,
+    tiffBitsPerSample = 258,
+    tiffCompression = 259,
+    tiffPhotometricInterpretation = 262,
+    tiffStripOffsets = 273,
+    tiffSamplesPerPixel = 277,
+    tiffRowsPerStrip = 278,
+    tiffStripByteCounts = 279,
+    tiffXResolution = 282,
+    tiffYResolution = 283,
+    tiffPlanarConfiguration = 284,
+    tiffResolutionUnit = 296,
+    tiffExtraSamples = 338,
+    tiffSampleFormat = 339,
+    tiffImageDepth = 32997
+};
+
+enum TiffFieldType {
+    tiffBYTE = 1,
+    tiffSHORT = 3,
+    tiffLONG = 4,
+    tiffRATIONAL = 5
+};
+
+inline bool host_is_big_endian() {
+    const uint16_t one = 1;
+    return *(const uint8_t *)&one == 0;
+}
+
+inline uint32_t read_tiff_uint(const uint8_t *src, int bytes, bool big_endian) {
+    uint32_t value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value = (value << 8) | src[big_endian ? i : bytes - 1 - i];
+    }
+    return value;
+}
+
+inline void swap_bytes(uint8_t *data, size_t count, int bytes) {
+    for (size_t i = 0; i < count; i++, data += bytes) {
+        std::reverse(data, data + bytes);
+    }
+}
+
+// The parts of the first directory of a TIFF file that describe its
+// payload.
+struct TiffInfo {
+    bool big_endian;
+    halide_type_t type;
+    int width, height, depth, channels;
+    bool planar;
+    int rows_per_strip;
+    std::vector<uint32_t> strip_offsets;
+
+    int dimensions() const {
+        return depth > 1 ? 4 : channels > 1 ? 3 : 2;
+    }
+
+    int planes() const {
+        return planar ? channels : 1;
+    }
+
+    // A row of a plane of the payload.
+    size_t row_bytes() const {
+        return (size_t)width * (planar ? 1 : channels) * type.bytes();
+    }
+
+    size_t payload_bytes() const {
+        return row_bytes() * height * depth * planes();
+    }
+
+    // The shape of a dense Buffer with the same layout as the payload.
+    std::vector<halide_dimension_t> shape() const {
+        const int x_stride = planar ? 1 : channels;
+        std::vector<halide_dimension_t> s = {
+            {0, width, x_stride, 0},
+            {0, height, x_stride * width, 0}
+        };
+        if (depth > 1) {
+            s.push_back({0, depth, x_stride * width * height, 0});
+        }
+        if (dimensions() > 2) {
+            s.push_back({0, channels, planar ? width * height * depth : 1, 0});
+        }
+        return s;
+    }
+
+    // Get the size of each strip. The strips of each plane hold
+    // rows_per_strip rows each, except the last, which holds the rest
+    // of the plane. (halide_debug_to_file writes one strip per plane
+    // even when the image has depth.)
+    bool strip_bytes(std::vector<size_t> *bytes) const {
+        const size_t strips_per_plane = strip_offsets.size() / planes();
+        if (strips_per_plane == 0 || strip_offsets.size() % planes() != 0) {
+            return false;
+        }
+        bytes->clear();
+        for (size_t i = 0; i < strip_offsets.size(); i++) {
+            const size_t k = i % strips_per_plane;
+            const int rows = (k + 1 == strips_per_plane) ?
+                height * depth - (int)k * rows_per_strip : rows_per_strip;
+            if (rows <= 0) {
+                return false;
+            }
+            bytes->push_back(rows * row_bytes());
+        }
+        return true;
+    }
+};
+
+template<CheckFunc check>
+bool read_tiff_header(FileOpener &f, TiffInfo *info) {
+    if (!check(f.f != nullptr, "File could not be opened for reading")) {
+        return false;
+    }
+
+    uint8_t header[8];
+    if (!check(f.read_array(header), "Could not read .tiff header")) {
+        return false;
+    }
+    if (!check((header[0] == 'I' && header[1] == 'I') || (header[0] == 'M' && header[1] == 'M'),
+               "File is not recognized as a TIFF file")) {
+        return false;
+    }
+    const bool big_endian = header[0] == 'M';
+    if (!check(read_tiff_uint(header + 2, 2, big_endian) == 42, "File is not recognized as a TIFF file")) {
+        return false;
+    }
+
+    uint8_t entry_count[2];
+    if (!check(fseek(f.f, read_tiff_uint(header + 4, 4, big_endian), SEEK_SET) == 0 &&
+               f.read_array(entry_count), "Could not read .tiff directory")) {
+        return false;
+    }
+    std::vector<uint8_t> entries(read_tiff_uint(entry_count, 2, big_endian) * 12);
+    if (!check(f.read_vector(&entries), "Could not read .tiff directory")) {
+        return false;
+    }
+
+    info->big_endian = big_endian;
+    info->width = info->height = 0;
+    info->depth = info->channels = 1;
+    info->planar = false;
+    info->rows_per_strip = 0;
+    info->strip_offsets.clear();
+    uint32_t bits = 1, sample_format = 1, compression = 1;
+    for (size_t i = 0; i < entries.size(); i += 12) {
+        const uint8_t *entry = &entries[i];
+        const uint32_t tag = read_tiff_uint(entry, 2, big_endian);
+        const uint32_t type = read_tiff_uint(entry + 2, 2, big_endian);
+        const uint32_t count = read_tiff_uint(entry + 4, 4, big_endian);
+        // All the fields we need are unsigned integers.
+        const int size = (type == tiffBYTE) ? 1 : (type == tiffSHORT) ? 2 : (type == tiffLONG) ? 4 : 0;
+        if (size == 0 || count == 0) {
+            continue;
+        }
+        std::vector<uint8_t> bytes(count * size);
+        if (bytes.size() <= 4) {
+            memcpy(bytes.data(), entry + 8, bytes.size());
+        } else {
+            const long pos = ftell(f.f);
+            if (!check(fseek(f.f, read_tiff_uint(entry + 8, 4, big_endian), SEEK_SET) == 0 &&
+                       f.read_vector(&bytes) &&
+                       fseek(f.f, pos, SEEK_SET) == 0, "Could not read .tiff directory")) {
+                return false;
+            }
+        }
+        std::vector<uint32_t> values(count);
+        for (uint32_t j = 0; j < count; j++) {
+            values[j] = read_tiff_uint(&bytes[j * size], size, big_endian);
+        }
+        switch (tag) {
+        case tiffImageWidth:
+            info->width = values[0];
+            break;
+        case tiffImageLength:
+            info->height = values[0];
+            break;
+        case tiffBitsPerSample:
+            bits = values[0];
+            if (!check(std::count(values.begin(), values.end(), bits) == (int)count,
+                       "TIFF files with samples of different sizes are not supported")) {
+                return false;
+            }
+            break;
+        case tiffCompression:
+            compression = values[0];
+            break;
+        case tiffStripOffsets:
+            info->strip_offsets = values;
+            break;
+        case tiffSamplesPerPixel:
+            info->channels = values[0];
+            break;
+        case tiffRowsPerStrip:
+            info->rows_per_strip = values[0];
+            break;
+        case tiffPlanarConfiguration:
+            info->planar = (values[0] == 2);
+            break;
+        case tiffSampleFormat:
+            sample_format = values[0];
+            if (!check(std::count(values.begin(), values.end(), sample_format) == (int)count,
+                       "TIFF files with samples of different formats are not supported")) {
+                return false;
+            }
+            break;
+        case tiffImageDepth:
+            info->depth = values[0];
+            break;
+        }
+    }
+
+    if (!check(compression == 1, "Compressed TIFF files are not supported")) {
+        return false;
+    }
+    if (!check(info->width > 0 && info->height > 0 && info->depth > 0 && info->channels > 0 &&
+               !info->strip_offsets.empty(), "Bad .tiff directory")) {
+        return false;
+    }
+    const halide_type_code_t codes[] = { halide_type_uint, halide_type_uint, halide_type_int, halide_type_float };
+    if (!check(sample_format >= 1 && sample_format <= 3, "Unsupported TIFF sample format")) {
+        return false;
+    }
+    info->type = halide_type_t(codes[sample_format], bits);
+    const bool valid_bits = (bits == 16 || bits == 32 || bits == 64 ||
+                             (bits == 8 && info->type.code != halide_type_float));
+    if (!check(valid_bits, "Unsupported TIFF sample size")) {
+        return false;
+    }
+    if (info->channels == 1) {
+        info->planar = false;
+    }
+    if (info->rows_per_strip <= 0 || info->rows_per_strip > info->height * info->depth) {
+        info->rows_per_strip = info->height * info->depth;
+    }
+    return true;
+}
+
+// Make the header and first directory of a TIFF file with the given
+// payload, in host byte order, with one strip per plane (per slice of
+// depth). The header is padded so that the payload after it is
+// aligned.
+template<CheckFunc check>
+bool make_tiff_header(TiffInfo *info, std::vector<uint8_t> *header) {
+    if (!check(info->payload_bytes() <= 0xffffffffu - 4096, "Image too large to save as .tiff")) {
+        return false;
+    }
+    info->big_endian = host_is_big_endian();
+    info->rows_per_strip = info->height;
+    const int strips = info->planes() * info->depth;
+    const size_t strip_bytes = info->row_bytes() * info->height;
+
+    struct Entry {
+        uint16_t tag, type;
+        std::vector<uint32_t> values;
+    };
+    const uint32_t sample_format = info->type.code == halide_type_float ? 3 :
+                                   info->type.code == halide_type_int ? 2 : 1;
+    const bool rgb = info->channels >= 3;
+    const int extra_samples = info->channels - (rgb ? 3 : 1);
+    std::vector<Entry> entries = {
+        { tiffImageWidth, tiffLONG, { (uint32_t)info->width } },
+        { tiffImageLength, tiffLONG, { (uint32_t)info->height } },
+        { tiffBitsPerSample, tiffSHORT, std::vector<uint32_t>(info->channels, info->type.bits) },
+        { tiffCompression, tiffSHORT, { 1 } },
+        { tiffPhotometricInterpretation, tiffSHORT, { rgb ? 2u : 1u } },
+        { tiffStripOffsets, tiffLONG, std::vector<uint32_t>(strips, 0) },
+        { tiffSamplesPerPixel, tiffSHORT, { (uint32_t)info->channels } },
+        { tiffRowsPerStrip, tiffLONG, { (uint32_t)info->rows_per_strip } },
+        { tiffStripByteCounts, tiffLONG, std::vector<uint32_t>(strips, (uint32_t)strip_bytes) },
+        { tiffXResolution, tiffRATIONAL, { 1, 1 } },
+        { tiffYResolution, tiffRATIONAL, { 1, 1 } },
+        { tiffPlanarConfiguration, tiffSHORT, { info->planar ? 2u : 1u } },
+        { tiffResolutionUnit, tiffSHORT, { 1 } },
+    };
+    if (extra_samples > 0) {
+        entries.push_back({ tiffExtraSamples, tiffSHORT, std::vector<uint32_t>(extra_samples, 0) });
+    }
+    entries.push_back({ tiffSampleFormat, tiffSHORT, std::vector<uint32_t>(info->channels, sample_format) });
+    if (info->depth > 1) {
+        entries.push_back({ tiffImageDepth, tiffLONG, { (uint32_t)info->depth } });
+    }
+
+    // Values that don't fit in an entry go after the directory.
+    const size_t directory_offset = 8;
+    const size_t extra_offset = directory_offset + 2 + entries.size() * 12 + 4;
+    size_t extra_size = 0;
+    for (const Entry &e : entries) {
+        const size_t bytes = e.values.size() * (e.type == tiffSHORT ? 2 : 4);
+        if (bytes > 4) {
+            extra_size += (bytes + 3) & ~3;
+        }
+    }
+    const size_t payload_offset = (extra_offset + extra_size + 15) & ~15;
+    info->strip_offsets.resize(strips);
+    for (int i = 0; i < strips; i++) {
+        info->strip_offsets[i] = (uint32_t)(payload_offset + i * strip_bytes);
+    }
+    entries[5].values = info->strip_offsets;
+
+    header->assign(payload_offset, 0);
+    uint8_t *dst = header->data();
+    auto put16 = [&](size_t pos, uint32_t v) { uint16_t v16 = (uint16_t)v; memcpy(dst + pos, &v16, 2); };
+    auto put32 = [&](size_t pos, uint32_t v) { memcpy(dst + pos, &v, 4); };
+    dst[0] = dst[1] = info->big_endian ? 'M' : 'I';
+    put16(2, 42);
+    put32(4, directory_offset);
+    put16(directory_offset, entries.size());
+    size_t extra = extra_offset;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry &e = entries[i];
+        const size_t pos = directory_offset + 2 + i * 12;
+        const int size = (e.type == tiffSHORT) ? 2 : 4;
+        const size_t bytes = e.values.size() * size;
+        put16(pos, e.tag);
+        put16(pos + 2, e.type);
+        put32(pos + 4, e.type == tiffRATIONAL ? e.values.size() / 2 : e.values.size());
+        size_t value_pos = pos + 8;
+        if (bytes > 4) {
+            put32(pos + 8, extra);
+            value_pos = extra;
+            extra += (bytes + 3) & ~3;
+        }
+        for (uint32_t v : e.values) {
+            if (size == 2) {
+                put16(value_pos, v);
+            } else {
+                put32(value_pos, v);
+            }
+            value_pos += size;
+        }
+    }
+    // The offset of the next directory (none) is already zero.
+    return true;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool load_tiff(const std::string &filename, ImageType *im) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    FileOpener f(filename, "rb");
+    TiffInfo info;
+    if (!read_tiff_header<check>(f, &info)) {
+        return false;
+    }
+    std::vector<size_t> strip_bytes;
+    if (!check(info.strip_bytes(&strip_bytes), "Bad .tiff strip layout")) {
+        return false;
+    }
+
+    // Read the strips straight into an image with the same layout.
+    std::vector<halide_dimension_t> shape = info.shape();
+    *im = ImageType(info.type, nullptr, (int)shape.size(), shape.data());
+    im->allocate();
+    uint8_t *dst = (uint8_t *)im->begin();
+    for (size_t i = 0; i < strip_bytes.size(); i++) {
+        if (!check(fseek(f.f, info.strip_offsets[i], SEEK_SET) == 0 &&
+                   f.read_bytes(dst, strip_bytes[i]), "Could not read .tiff payload")) {
+            return false;
+        }
+        dst += strip_bytes[i];
+    }
+    if (info.big_endian != host_is_big_endian() && info.type.bytes() > 1) {
+        swap_bytes((uint8_t *)im->begin(), info.payload_bytes() / info.type.bytes(), info.type.bytes());
+    }
+
+    im->set_host_dirty();
+    return true;
+}
+
+inline const std::set<FormatInfo> &query_tiff() {
+    static std::set<FormatInfo> info = []() {
+        std::set<FormatInfo> s;
+        for (int i = 2; i <= 4; i++) {
+            s.insert({ halide_type_t(halide_type_float, 16), i });
+            s.insert({ halide_type_t(halide_type_float, 32), i });
+            s.insert({ halide_type_t(halide_type_float, 64), i });
+            s.insert({ halide_type_t(halide_type_uint, 8), i });
+            s.insert({ halide_type_t(halide_type_int, 8), i });
+            s.insert({ halide_type_t(halide_type_uint, 16), i });
+            s.insert({ halide_type_t(halide_type_int, 16), i });
+            s.insert({ halide_type_t(halide_type_uint, 32), i });
+            s.insert({ halide_type_t(halide_type_int, 32), i });
+            s.insert({ halide_type_t(halide_type_uint, 64), i });
+            s.insert({ halide_type_t(halide_type_int, 64), i });
+        }
+        return s;
+    }();
+    return info;
+}
+
+template<typename ImageType, CheckFunc check = CheckReturn>
+bool save_tiff(ImageType &im, const std::string &filename) {
+    static_assert(!ImageType::has_static_halide_type, "");
+
+    im.copy_to_host();
+
+    const int dims = im.dimensions();
+    if (!check(dims >= 2 && dims <= 4, "Can only save 2, 3, or 4-dimensional images as .tiff")) {
+        return false;
+    }
+    if (!check(query_tiff().count({ im.type(), dims }) > 0, "Unsupported type for .tiff file")) {
+        return false;
+    }
+
+    TiffInfo info;
+    info.type = im.type();
+    info.width = im.dim(0).extent();
+    info.height = im.dim(1).extent();
+    info.depth = (dims == 4) ? im.dim(2).extent() : 1;
+    info.channels = (dims > 2) ? im.dim(dims - 1).extent() : 1;
+    // Keep interleaved images interleaved.
+    info.planar = !(info.channels > 1 && im.dim(dims - 1).stride() == 1);
+
+    // Write the payload in one go from the image if it already has the
+    // layout of the file, or else from a copy of it that does.
+    std::vector<halide_dimension_t> shape = info.shape();
+    bool same_layout = true;
+    for (int d = 0; d < dims; d++) {
+        shape[d].min = im.dim(d).min();
+        same_layout = same_layout && (shape[d].stride == im.dim(d).stride() || shape[d].extent == 1);
+    }
+    ImageType payload = im;
+    if (!same_layout) {
+        payload = ImageType(info.type, nullptr, dims, shape.data());
+        payload.allocate();
+        payload.copy_from(im);
+    }
+
+    std::vector<uint8_t> header;
+    if (!make_tiff_header<check>(&info, &header)) {
+        return false;
+    }
+
+    FileOpener f(filename, "wb");
+    if (!check(f.f != nullptr, "File could not be opened for writing")) {
+        return false;
+    }
+    if (!check(f.write_vector(header), "Could not write .tiff header")) {
+        return false;
+    }
+    if (!check(f.write_bytes(payload.begin(), info.payload_bytes()), "Could not write .tiff payload")) {
+        return false;
+    }
+
+    return true;
+}
+
+
 template<typename ImageType, Internal::CheckFunc check>
 struct ImageIO {
     std::function<bool(const std::string &, ImageType *)> load;
@@ -1323,7 +1808,9 @@ bool find_imageio(const std::string &filename, ImageIO<ImageType, check> *result
 #endif
         {"ppm", {load_ppm<ImageType, check>, save_ppm<ImageType, check>, query_ppm}},
         {"tmp", {load_tmp<ImageType, check>, save_tmp<ImageType, check>, query_tmp}},
-        {"mat", {load_mat<ImageType, check>, save_mat<ImageType, check>, query_mat}}
+        {"mat", {load_mat<ImageType, check>, save_mat<ImageType, check>, query_mat}},
+        {"tif", {load_tiff<ImageType, check>, save_tiff<ImageType, check>, query_tiff}},
+        {"tiff", {load_tiff<ImageType, check>, save_tiff<ImageType, check>, query_tiff}}
     };
     std::string ext = Internal::get_lowercase_extension(filename);
     auto it = m.find(ext);
@@ -1379,6 +1866,158 @@ FormatInfo best_save_format(const ImageType &im, const std::set<FormatInfo> &inf
     return best;
 }
 
+#ifndef _WIN32
+
+// A memory-mapped file. Buffers that alias the mapping share ownership
+// of it through the AllocationHeader it starts with, and the last one
+// to be destroyed unmaps it.
+struct MappedFile : public Halide::Runtime::AllocationHeader {
+    void *addr;
+    size_t length;
+
+    static void unmap(void *p) {
+        MappedFile *m = static_cast<MappedFile *>((Halide::Runtime::AllocationHeader *)p);
+        munmap(m->addr, m->length);
+        delete m;
+    }
+};
+
+// Map a whole file into memory. Files mapped for reading are mapped
+// copy-on-write, so that writes to the mapping never reach the
+// file. Files mapped for writing are created (or truncated) with the
+// given size first. Returns nullptr on failure.
+inline MappedFile *map_file(const std::string &filename, bool writable, size_t size) {
+    int fd = writable ?
+        open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) :
+        open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat st;
+    if (writable) {
+        if (ftruncate(fd, size) != 0) {
+            close(fd);
+            return nullptr;
+        }
+    } else if (fstat(fd, &st) == 0) {
+        size = st.st_size;
+    } else {
+        size = 0;
+    }
+    void *addr = size > 0 ?
+        mmap(nullptr, size, PROT_READ | PROT_WRITE, writable ? MAP_SHARED : MAP_PRIVATE, fd, 0) :
+        MAP_FAILED;
+    close(fd);
+    if (addr == MAP_FAILED) {
+        return nullptr;
+    }
+    MappedFile *m = new MappedFile;
+    m->deallocate_fn = MappedFile::unmap;
+    m->addr = addr;
+    m->length = size;
+    return m;
+}
+
+#endif  // not _WIN32
+
+// The layout of the payload of an image file: where it starts, its
+// type, and the shape of a Buffer that aliases it.
+struct PayloadLayout {
+    size_t offset;
+    halide_type_t type;
+    std::vector<halide_dimension_t> shape;
+
+    size_t size_in_bytes() const {
+        size_t size = type.bytes();
+        for (const auto &d : shape) {
+            size *= d.extent;
+        }
+        return size;
+    }
+
+    void set_planar_shape(const std::vector<int> &extents) {
+        shape.clear();
+        int stride = 1;
+        for (int e : extents) {
+            shape.push_back({0, e, stride, 0});
+            stride *= e;
+        }
+    }
+
+    // The start of the payload must be aligned to the element size,
+    // as Halide pipelines assume. The mapping itself is page-aligned.
+    bool is_aligned() const {
+        return offset % type.bytes() == 0;
+    }
+};
+
+// Find the layout of the payload of an image file, if it is stored
+// in native byte order with no compression, so that a Buffer can
+// alias it directly.
+inline bool find_payload_layout(const std::string &filename, PayloadLayout *layout) {
+    const std::string ext = get_lowercase_extension(filename);
+    FileOpener f(filename, "rb");
+    if (f.f == nullptr) {
+        return false;
+    }
+    if (ext == "tmp") {
+        int32_t header[5];
+        if (!f.read_array(header) ||
+            !(header[0] > 0 && header[1] > 0 && header[2] > 0 && header[3] > 0 &&
+              header[4] >= 0 && header[4] < kNumTmpCodes)) {
+            return false;
+        }
+        layout->type = tmp_code_to_halide_type()[header[4]];
+        layout->set_planar_shape({header[0], header[1], header[2], header[3]});
+    } else if (ext == "mat") {
+        std::vector<int> extents;
+        if (!read_mat_header<CheckReturn>(f, &layout->type, &extents)) {
+            return false;
+        }
+        layout->set_planar_shape(extents);
+    } else if (ext == "pgm" || ext == "ppm") {
+        // Only 8-bit files can be mapped: 16-bit ones are big-endian.
+        const int channels = (ext == "ppm") ? 3 : 1;
+        int width, height, bit_depth;
+        if (!read_pnm_header<CheckReturn>(f, channels == 3 ? "P6" : "P5", &width, &height, &bit_depth) ||
+            bit_depth != 8) {
+            return false;
+        }
+        layout->type = halide_type_t(halide_type_uint, 8);
+        layout->shape = {{0, width, channels, 0}, {0, height, width * channels, 0}};
+        if (channels > 1) {
+            layout->shape.push_back({0, channels, 1, 0});
+        }
+    } else if (ext == "tif" || ext == "tiff") {
+        // The strips must be in host byte order, and follow one another
+        // in the file.
+        TiffInfo info;
+        std::vector<size_t> strip_bytes;
+        if (!read_tiff_header<CheckReturn>(f, &info) ||
+            info.big_endian != host_is_big_endian() ||
+            !info.strip_bytes(&strip_bytes)) {
+            return false;
+        }
+        for (size_t i = 1; i < strip_bytes.size(); i++) {
+            if (info.strip_offsets[i] != info.strip_offsets[i - 1] + strip_bytes[i - 1]) {
+                return false;
+            }
+        }
+        layout->type = info.type;
+        layout->shape = info.shape();
+        layout->offset = info.strip_offsets[0];
+        return layout->is_aligned();
+    } else {
+        return false;
+    }
+    long offset = ftell(f.f);
+    if (offset < 0) {
+        return false;
+    }
+    layout->offset = offset;
+    return layout->is_aligned();
+}
+
 }  // namespace Internal
 
 struct ImageTypeConversion {
@@ -1617,6 +2256,136 @@ bool save_query(const std::string &filename, std::set<FormatInfo> *info) {
     return true;
 }
 
+// Load an image by memory-mapping the file, so that the image aliases
+// the file's payload instead of holding a copy of it. This only works
+// for files stored in native byte order with no compression: .tmp,
+// .mat, uncompressed .tiff files whose strips are contiguous, and 8-bit
+// .pgm and .ppm files (which load as interleaved images). Other files, or any file on Windows, are loaded with
+// load(). Writes to a mapped image are private to this process, and
+// never reach the file. Returns false upon failure.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool load_mapped(const std::string &filename, ImageType *im) {
+#ifndef _WIN32
+    using DynamicImageType = typename Internal::ImageTypeWithElemType<ImageType, void>::type;
+    Internal::PayloadLayout layout;
+    if (Internal::find_payload_layout(filename, &layout) &&
+        (!ImageType::has_static_halide_type || layout.type == ImageType::static_halide_type())) {
+        Internal::MappedFile *m = Internal::map_file(filename, false, 0);
+        if (m && m->length >= layout.offset + layout.size_in_bytes()) {
+            Halide::Runtime::Buffer<> b(layout.type, (uint8_t *)m->addr + layout.offset,
+                                        (int)layout.shape.size(), layout.shape.data());
+            b.adopt_allocation(m);
+            DynamicImageType im_d(std::move(b));
+            *im = im_d.template as<typename ImageType::ElemType>();
+            return true;
+        }
+        if (m) {
+            Internal::MappedFile::unmap(m);
+        }
+    }
+#endif
+    return load<ImageType, check>(filename, im);
+}
+
+// Create an image file of the given type and shape, and memory-map it,
+// so that a pipeline can write its output directly into the file
+// through the image returned. The file is complete once the last image
+// referring to the mapping is destroyed. Supports .tmp files (other
+// than 64-bit types, whose payload would be misaligned), planar .tiff
+// files, and 8-bit .pgm and .ppm files (which are interleaved). Not supported on Windows.
+// Returns false upon failure.
+template<typename ImageType, Internal::CheckFunc check = Internal::CheckReturn>
+bool create_mapped(const std::string &filename, halide_type_t type,
+                   const std::vector<int> &extents, ImageType *im) {
+#ifndef _WIN32
+    using DynamicImageType = typename Internal::ImageTypeWithElemType<ImageType, void>::type;
+    if (ImageType::has_static_halide_type &&
+        !check(type == ImageType::static_halide_type(), "Type does not match the image type")) {
+        return false;
+    }
+
+    const std::string ext = Internal::get_lowercase_extension(filename);
+    Internal::PayloadLayout layout;
+    layout.type = type;
+    std::vector<uint8_t> header;
+    if (ext == "tmp") {
+        int32_t tmp_header[5] = { 1, 1, 1, 1, -1 };
+        if (!check(extents.size() <= 4, "Too many dimensions for a .tmp file")) {
+            return false;
+        }
+        for (size_t i = 0; i < extents.size(); i++) {
+            tmp_header[i] = extents[i];
+        }
+        auto *table = Internal::tmp_code_to_halide_type();
+        for (int i = 0; i < Internal::kNumTmpCodes; i++) {
+            if (type == table[i]) {
+                tmp_header[4] = i;
+                break;
+            }
+        }
+        if (!check(tmp_header[4] >= 0, "Unsupported type for .tmp file")) {
+            return false;
+        }
+        header.resize(sizeof(tmp_header));
+        memcpy(header.data(), tmp_header, sizeof(tmp_header));
+        layout.set_planar_shape(extents);
+    } else if (ext == "pgm" || ext == "ppm") {
+        const size_t channels = (ext == "ppm") ? 3 : 1;
+        if (!check(type == halide_type_t(halide_type_uint, 8),
+                   "Only 8-bit .pgm and .ppm files can be memory-mapped") ||
+            !check(extents.size() == (channels == 3 ? 3 : 2) && (channels == 1 || extents[2] == 3),
+                   "Wrong shape for a .pgm or .ppm file")) {
+            return false;
+        }
+        const int width = extents[0], height = extents[1];
+        const std::string pnm_header = std::string(channels == 3 ? "P6" : "P5") + "\n" +
+            std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+        header.assign(pnm_header.begin(), pnm_header.end());
+        layout.shape = {{0, width, (int)channels, 0}, {0, height, width * (int)channels, 0}};
+        if (channels > 1) {
+            layout.shape.push_back({0, (int)channels, 1, 0});
+        }
+    } else if (ext == "tif" || ext == "tiff") {
+        const int dims = (int)extents.size();
+        if (!check(dims >= 2 && dims <= 4, "Can only save 2, 3, or 4-dimensional images as .tiff") ||
+            !check(Internal::query_tiff().count({ type, dims }) > 0, "Unsupported type for .tiff file")) {
+            return false;
+        }
+        Internal::TiffInfo info;
+        info.type = type;
+        info.width = extents[0];
+        info.height = extents[1];
+        info.depth = (dims == 4) ? extents[2] : 1;
+        info.channels = (dims > 2) ? extents[dims - 1] : 1;
+        info.planar = true;
+        if (!Internal::make_tiff_header<check>(&info, &header)) {
+            return false;
+        }
+        layout.shape = info.shape();
+    } else {
+        return check(false, "Only .tmp, .tiff, .pgm and .ppm files can be memory-mapped for writing");
+    }
+
+    layout.offset = header.size();
+    if (!check(layout.is_aligned(), "The payload of this file would not be aligned")) {
+        return false;
+    }
+    Internal::MappedFile *m = Internal::map_file(filename, true, layout.offset + layout.size_in_bytes());
+    if (!check(m != nullptr, "File could not be mapped for writing")) {
+        return false;
+    }
+    memcpy(m->addr, header.data(), header.size());
+    Halide::Runtime::Buffer<> b(type, (uint8_t *)m->addr + layout.offset,
+                                (int)layout.shape.size(), layout.shape.data());
+    b.adopt_allocation(m);
+    DynamicImageType im_d(std::move(b));
+    *im = im_d.template as<typename ImageType::ElemType>();
+    return true;
+#else
+    return check(false, "Memory-mapped files are not supported on Windows");
+#endif
+}
+
 // Fancy wrapper to call load() with CheckFail, inferring the return type;
 // this allows you to simply use
 //
@@ -0,0 +1,131 @@
+// This header defines a driver that realizes a pipeline over an image
+// larger than memory, one strip of the output at a time, reading the
+// input and writing the output as it goes.
+//
+// It requires Halide.h, and uses halide_image_io.h to access the files.
+
+#ifndef HALIDE_STREAM_IO_H
+#define HALIDE_STREAM_IO_H
+
+#include <algorithm>
+#include <future>
+#include <string>
+#include <vector>
+
+#include "Halide.h"
+#include "halide_image_io.h"
+
+namespace Halide {
+namespace Tools {
+
+// Realize a pipeline with a single output Func, and a single input
+// ImageParam that it has not been bound to, in horizontal strips of
+// the given height. For each strip of the output, this infers the
+// region of the input it requires, calls read(region) to fill in a
+// Buffer<> of that shape (its mins are in the coordinates of the whole
+// input), realizes the strip, and calls write(strip) with it. The
+// input of the next strip is read, and the previous strip written, on
+// other threads while each strip is being computed, so at most two
+// strips of each are in memory at any time.
+//
+// The bounds of the input are those of the current strip while it is
+// realized, so any boundary condition on it must be given its bounds
+// explicitly (e.g. BoundaryConditions::repeat_edge(input, {{0, width},
+// {0, height}})), and the pipeline must not otherwise depend on them.
+template<typename ReadFn, typename WriteFn>
+void realize_in_strips(Pipeline p, ImageParam input, const std::vector<int> &output_extents,
+                       int strip_height, ReadFn read, WriteFn write) {
+    const Type output_type = p.outputs()[0].output_types()[0];
+    const int height = output_extents.size() > 1 ? output_extents[1] : 1;
+    if (strip_height <= 0 || output_extents.size() < 2) {
+        strip_height = height;
+    }
+
+    // Make the buffer for the strip of the output starting at row y,
+    // and allocate the buffer for the region of the input it needs.
+    auto make_strip = [&](int y, Buffer<> *out, Buffer<> *in) {
+        std::vector<int> extents = output_extents;
+        if (extents.size() > 1) {
+            extents[1] = std::min(strip_height, height - y);
+        }
+        *out = Buffer<>(output_type, extents);
+        if (extents.size() > 1) {
+            out->translate(1, y);
+        }
+        input.reset();
+        p.infer_input_bounds(*out);
+        *in = input.get();
+        input.reset();
+    };
+
+    Buffer<> out, in;
+    make_strip(0, &out, &in);
+    std::future<void> reading = std::async(std::launch::async, read, in), writing;
+    for (int y = 0; y < height; y += strip_height) {
+        reading.get();
+        Buffer<> next_out, next_in;
+        if (y + strip_height < height) {
+            make_strip(y + strip_height, &next_out, &next_in);
+            reading = std::async(std::launch::async, read, next_in);
+        }
+
+        input.set(in);
+        p.realize(out);
+        input.reset();
+
+        if (writing.valid()) {
+            writing.get();
+        }
+        writing = std::async(std::launch::async, write, out);
+        out = next_out;
+        in = next_in;
+    }
+    writing.get();
+}
+
+// Realize a pipeline as above, reading its input from one image file
+// and writing its output to another. The input is memory-mapped if its
+// format allows (see load_mapped), so that only the region each strip
+// needs is read from the file; otherwise it is loaded into memory
+// whole. The output must be a format that create_mapped supports:
+// each strip is copied into the mapped output file as it completes.
+// The output has the given extents, or the extents of the input if
+// none are given. Returns false upon failure.
+template<Internal::CheckFunc check = Internal::CheckReturn>
+bool stream_image(Pipeline p, ImageParam input,
+                  const std::string &input_filename, const std::string &output_filename,
+                  std::vector<int> output_extents = {}, int strip_height = 64) {
+    Buffer<> src;
+    if (!load_mapped<Buffer<>, check>(input_filename, &src)) {
+        return false;
+    }
+    if (!check(src.type() == input.type() && src.dimensions() == input.dimensions(),
+               "Input file does not match the type and dimensionality of the ImageParam")) {
+        return false;
+    }
+    if (output_extents.empty()) {
+        for (int d = 0; d < src.dimensions(); d++) {
+            output_extents.push_back(src.dim(d).extent());
+        }
+    }
+
+    Buffer<> dst;
+    if (!create_mapped<Buffer<>, check>(output_filename, p.outputs()[0].output_types()[0],
+                                        output_extents, &dst)) {
+        return false;
+    }
+
+    realize_in_strips(p, input, output_extents, strip_height,
+                      [&](Buffer<> region) {
+                          region.copy_from(src);
+                      },
+                      [&](Buffer<> strip) {
+                          dst.copy_from(strip);
+                      });
+    return true;
+}
+
+}  // namespace Tools
+}  // namespace Halide
+
+#endif  // HALIDE_STREAM_IO_H